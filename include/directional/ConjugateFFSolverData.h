@@ -14,6 +14,7 @@
 #include <Eigen/Sparse>
 #include <igl/dot_row.h>
 #include <iostream>
+#include <directional/MeshContext.h>
 
 
 using namespace std;
@@ -65,10 +66,14 @@ namespace directional
     IGL_INLINE void computeCoefficientLaplacian(int n, Eigen::SparseMatrix<std::complex<double> > &D);
     
     IGL_INLINE void precomputeInteriorEdges();
+    IGL_INLINE void precomputeFromTopology();
     
   public:
     IGL_INLINE ConjugateFFSolverData(const Eigen::Matrix<double, Eigen::Dynamic, 3> &_V,
                                      const Eigen::MatrixXi &_F);
+    
+    // Version with the topology and local basis taken from a MeshContext.
+    IGL_INLINE ConjugateFFSolverData(const MeshContext &mesh);
     IGL_INLINE void evaluateConjugacy(const Eigen::Matrix<double, Eigen::Dynamic, 12> rawField,
                                       Eigen::Matrix<double, Eigen::Dynamic, 1> &conjValues) const ;
     
@@ -95,20 +100,39 @@ F(_F),
 numF(_F.rows())
 {
   igl::edge_topology(V,F,EV,F2E,E2F);
+  igl::local_basis(V,F,B1,B2,FN);
+  precomputeFromTopology();
+};
+
+IGL_INLINE directional::ConjugateFFSolverData::
+ConjugateFFSolverData(const MeshContext &mesh):
+V(mesh.V),
+numV(mesh.V.rows()),
+F(mesh.F),
+numF(mesh.F.rows()),
+EV(mesh.EV()),
+F2E(mesh.FE()),
+E2F(mesh.EF()),
+B1(mesh.B1()),
+B2(mesh.B2()),
+FN(mesh.FN())
+{
+  precomputeFromTopology();
+};
+
+IGL_INLINE void directional::ConjugateFFSolverData::precomputeFromTopology()
+{
   numE = EV.rows();
   
   precomputeInteriorEdges();
   
-  igl::local_basis(V,F,B1,B2,FN);
-  
   computek();
   
   computeLaplacians();
   
   computeCurvatureAndPrincipals();
   precomputeConjugacyStuff();
-  
-};
+}
 
 
 IGL_INLINE void directional::ConjugateFFSolverData::computeCurvatureAndPrincipals()
@@ -0,0 +1,101 @@
+// This file is part of Directional, a library for directional field processing.
+// Copyright (C) 2018 Amir Vaxman <avaxman@gmail.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef DIRECTIONAL_INDEX_PRESCRIPTION_SOLVER_H
+#define DIRECTIONAL_INDEX_PRESCRIPTION_SOLVER_H
+
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+#include <Eigen/SparseCholesky>
+#include <igl/igl_inline.h>
+#include <igl/PI.h>
+#include <directional/MeshContext.h>
+
+namespace directional
+{
+  // Index prescription (see index_prescription.h) for many candidate sets of indices on the same mesh.
+  // The solver owns the factorization of basisCycles*basisCycles^T, which depends only on the mesh, and solves
+  // a batch of candidates as a single multi-column right-hand side.
+  class IndexPrescriptionSolver
+  {
+  public:
+    int N;
+    Eigen::MatrixXi EV;                   // #E by 2 edges
+    Eigen::VectorXi innerEdges;           // #iE inner edges
+    Eigen::SparseMatrix<double> basisCycles;  // #c by #iE basis cycles
+    Eigen::VectorXd cycleCurvature;       // #c original curvature of each basis cycle
+    Eigen::SimplicialLDLT<Eigen::SparseMatrix<double> > ldltSolver;
+    
+    // Inputs:
+    //  EV, innerEdges, basisCycles, cycleCurvature: as in index_prescription() (obtained from directional::dual_cycles).
+    //  N: the degree of the field.
+    IGL_INLINE IndexPrescriptionSolver(const Eigen::MatrixXi& _EV,
+                                       const Eigen::VectorXi& _innerEdges,
+                                       const Eigen::SparseMatrix<double>& _basisCycles,
+                                       const Eigen::VectorXd& _cycleCurvature,
+                                       const int _N):N(_N), EV(_EV), innerEdges(_innerEdges), basisCycles(_basisCycles), cycleCurvature(_cycleCurvature)
+    {
+      factorize();
+    }
+    
+    IGL_INLINE IndexPrescriptionSolver(const MeshContext& mesh,
+                                       const int _N):N(_N), EV(mesh.EV()), innerEdges(mesh.innerEdges()), basisCycles(mesh.basisCycles()), cycleCurvature(mesh.cycleCurvature())
+    {
+      factorize();
+    }
+    
+    // Computes the rotation angles for a single set of indices.
+    // Input:
+    //  cycleIndices: #c the prescribed index around each cycle.
+    // Output:
+    //  rotationAngles: #E rotation angles (difference from parallel transport) per dual edge, zero on the boundary
+    //  linfError: l_infinity error of the computation. If this is not approximately 0, the prescribed indices are likely inconsistent.
+    IGL_INLINE void solve(const Eigen::VectorXi& cycleIndices,
+                          Eigen::VectorXd& rotationAngles,
+                          double& linfError) const
+    {
+      Eigen::MatrixXd rotationAnglesBatch;
+      Eigen::VectorXd linfErrors;
+      solve(Eigen::MatrixXi(cycleIndices), rotationAnglesBatch, linfErrors);
+      rotationAngles=rotationAnglesBatch.col(0);
+      linfError=linfErrors(0);
+    }
+    
+    // Computes the rotation angles for K candidate sets of indices with a single blocked solve.
+    // Input:
+    //  cycleIndices: #c by K prescribed indices, a candidate per column.
+    // Output:
+    //  rotationAngles: #E by K rotation angles per candidate
+    //  linfErrors: K l_infinity errors per candidate
+    IGL_INLINE void solve(const Eigen::MatrixXi& cycleIndices,
+                          Eigen::MatrixXd& rotationAngles,
+                          Eigen::VectorXd& linfErrors) const
+    {
+      using namespace Eigen;
+      assert(cycleIndices.rows()==basisCycles.rows());
+      
+      MatrixXd rhs = cycleIndices.cast<double>()*(2.0*igl::PI/(double)N);
+      rhs.colwise() -= cycleCurvature;
+      MatrixXd innerRotationAngles = basisCycles.transpose()*ldltSolver.solve(rhs);
+      
+      rotationAngles=MatrixXd::Zero(EV.rows(), cycleIndices.cols());
+      for (int i=0;i<innerEdges.rows();i++)
+        rotationAngles.row(innerEdges(i))=innerRotationAngles.row(i);
+      
+      linfErrors = (basisCycles*innerRotationAngles - rhs).cwiseAbs().colwise().maxCoeff().transpose();
+    }
+    
+  private:
+    IGL_INLINE void factorize()
+    {
+      Eigen::SparseMatrix<double> AAt = basisCycles*basisCycles.transpose();
+      ldltSolver.compute(AAt);
+    }
+  };
+}
+
+#endif
@@ -0,0 +1,106 @@
+// This file is part of Directional, a library for directional field processing.
+// Copyright (C) 2021 Amir Vaxman <avaxman@gmail.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef DIRECTIONAL_INDEXED_MIN_HEAP_H
+#define DIRECTIONAL_INDEXED_MIN_HEAP_H
+
+#include <vector>
+#include <cassert>
+
+namespace directional
+{
+  // A binary min-heap of ids in [0,maxId) keyed by doubles, where the key of any id in the heap can be changed in logarithmic time.
+  class IndexedMinHeap
+  {
+  public:
+    void init(const int maxId){
+      heap.clear();
+      positions.assign(maxId, -1);
+      keys.assign(maxId, 0.0);
+    }
+
+    bool empty() const {return heap.empty();}
+    int size() const {return heap.size();}
+    bool contains(const int id) const {return positions[id]!=-1;}
+    double key(const int id) const {return keys[id];}
+    int top() const {assert(!heap.empty()); return heap[0];}
+    double top_key() const {return keys[top()];}
+
+    // The ids in the heap, in heap order.
+    const std::vector<int>& ids() const {return heap;}
+
+    // Inserts id, or changes its key if it is already in the heap.
+    void push(const int id, const double key){
+      if (contains(id)){
+        update(id, key);
+        return;
+      }
+      keys[id]=key;
+      positions[id]=heap.size();
+      heap.push_back(id);
+      sift_up(heap.size()-1);
+    }
+
+    void update(const int id, const double key){
+      assert(contains(id));
+      double oldKey=keys[id];
+      keys[id]=key;
+      if (key<oldKey)
+        sift_up(positions[id]);
+      else
+        sift_down(positions[id]);
+    }
+
+    // Removes and returns the id with the smallest key.
+    int pop(){
+      int id=top();
+      swap_positions(0, heap.size()-1);
+      heap.pop_back();
+      positions[id]=-1;
+      if (!heap.empty())
+        sift_down(0);
+      return id;
+    }
+
+  private:
+    std::vector<int> heap;         // ids in heap order
+    std::vector<int> positions;    // position of each id in heap, or -1 if it is not in the heap
+    std::vector<double> keys;
+
+    void swap_positions(const int i, const int j){
+      std::swap(heap[i], heap[j]);
+      positions[heap[i]]=i;
+      positions[heap[j]]=j;
+    }
+
+    void sift_up(int i){
+      while (i>0){
+        int parent=(i-1)/2;
+        if (keys[heap[parent]]<=keys[heap[i]])
+          break;
+        swap_positions(i, parent);
+        i=parent;
+      }
+    }
+
+    void sift_down(int i){
+      const int heapSize=heap.size();
+      while (true){
+        int smallest=i, left=2*i+1, right=2*i+2;
+        if ((left<heapSize)&&(keys[heap[left]]<keys[heap[smallest]]))
+          smallest=left;
+        if ((right<heapSize)&&(keys[heap[right]]<keys[heap[smallest]]))
+          smallest=right;
+        if (smallest==i)
+          break;
+        swap_positions(i, smallest);
+        i=smallest;
+      }
+    }
+  };
+}
+
+#endif
@@ -15,7 +15,9 @@
 #include <igl/slice.h>
 #include <igl/diag.h>
 #include <directional/SIInitialSolutionTraits.h>
+#include <igl/Timer.h>
 #include <directional/sparse_block.h>
+#include <directional/IndexedMinHeap.h>
 
 
 template <class LinearSolver>
@@ -34,16 +36,32 @@ public:
   int N,n;
   double lengthRatio, paramLength, fraction;
   double wConst, wBarrier, wClose, s, wPoisson;
-  Eigen::VectorXi leftIndices;
+  //the indices left to round, keyed by their distance from an integer. After every LM solve, the key of an index is recomputed if its value
+  //has moved by more than keyUpdateThreshold from keyValues, the value the key was computed from. With the default threshold of 0, every moved
+  //index is re-keyed and the rounding order is exact; otherwise a key is stale by at most fraction*keyUpdateThreshold.
+  directional::IndexedMinHeap leftHeap;
+  Eigen::VectorXd keyValues;
+  double keyUpdateThreshold;
   bool roundedSingularities, roundSeams, localInjectivity;
   
   double origValue,roundValue;
   int currRoundIndex;
   
+  //rounding all the left indices within roundingTolerance of an integer in a single solve, rather than one at a time
+  bool blockRounding;
+  double roundingTolerance;
+  int numRounded;  //in the last call to initFixedIndices()
+  
+  //statistics of initFixedIndices(), separating the selection of the rounded indices from the update of the jacobian
+  int numSelections, numKeyUpdates;
+  double selectionTime, jacobianTime;
+  
   bool success;
   
-  //elements of the jacobian which are fixed
+  //elements of the jacobian which are fixed. The objective and closeness parts are computed once, and the constness part only gets new rows for new fixed indices.
   Eigen::SparseMatrix<double> gObj,gClose,gConst,G2UFullParamLength, gObjCloseConst;
+  Eigen::SparseMatrix<double, Eigen::RowMajor> UFullRows;
+  std::vector<Eigen::Triplet<double> > gObjCloseTriplets, gConstTriplets;
   
   void initial_solution(Eigen::VectorXd& _x0){
     _x0 = x0Small;
@@ -53,84 +71,91 @@ public:
   void pre_iteration(const Eigen::VectorXd& prevx){}
   bool post_iteration(const Eigen::VectorXd& x){return false;}
 
-  IterativeRoundingTraits() :ESize(0), xSize(0) {}
+  IterativeRoundingTraits() :ESize(0), xSize(0), keyUpdateThreshold(0.0), blockRounding(false), roundingTolerance(0.1), numRounded(0), numSelections(0), numKeyUpdates(0), selectionTime(0.0), jacobianTime(0.0) {}
   ~IterativeRoundingTraits() {}
   
   
+  double round_diff(const int index) const {
+    return std::fabs(fraction * xCurr(index) - std::round(fraction * xCurr(index)));
+  }
+  
+  void push_left_index(const int index){
+    keyValues(index) = xCurr(index);
+    leftHeap.push(index, round_diff(index));
+  }
+  
+  void set_left_indices(const Eigen::VectorXi& indices){
+    leftHeap.init(xCurr.size());
+    keyValues.resize(xCurr.size());
+    for (int i = 0; i < indices.size(); i++)
+      push_left_index(indices(i));
+  }
+  
+  //re-keys the left indices whose value has moved since their key was computed
+  void update_left_keys(){
+    std::vector<int> movedIndices;
+    const std::vector<int>& heapIndices = leftHeap.ids();
+    for (size_t i = 0; i < heapIndices.size(); i++)
+      if (std::fabs(xCurr(heapIndices[i]) - keyValues(heapIndices[i])) > keyUpdateThreshold)
+        movedIndices.push_back(heapIndices[i]);
+    for (size_t i = 0; i < movedIndices.size(); i++)
+      push_left_index(movedIndices[i]);
+    numKeyUpdates += movedIndices.size();
+  }
+  
   bool initFixedIndices() {
       using namespace Eigen;
       using namespace std;
 
+      igl::Timer timer;
+      timer.start();
       xPrevSmall = xCurrSmall;
       xCurr = UFull * xCurrSmall;
+      update_left_keys();
 
-
-      VectorXd roundDiffs(leftIndices.size());
-      double minRoundDiff = 3276700.0;
-      int minRoundIndex = -1;
-      for (int i = 0; i < leftIndices.size(); i++) {
-          //cout<<"fraction*xCurr(leftIndices(i)): "<<fraction*xCurr(leftIndices(i))<<endl;
-          //cout<<"std::round(fraction*xCurr(leftIndices(i))): "<<std::round(fraction*xCurr(leftIndices(i)))<<endl;
-          roundDiffs(i) = std::fabs(fraction * xCurr(leftIndices(i)) - std::round(fraction * xCurr(leftIndices(i))));
-          if (roundDiffs(i) < minRoundDiff) {
-              minRoundIndex = i;
-              minRoundDiff = roundDiffs(i);
-              // cout<<"minRoundDiff: "<<minRoundDiff<<endl;
-          }
+      //the closest index is always rounded, and with block rounding also every other one within the tolerance
+      vector<int> roundIndices(1, leftHeap.pop());
+      double maxRoundDiff = round_diff(roundIndices[0]);
+      while ((blockRounding) && (!leftHeap.empty()) && (leftHeap.top_key() <= roundingTolerance)) {
+          roundIndices.push_back(leftHeap.pop());
+          maxRoundDiff = std::max(maxRoundDiff, round_diff(roundIndices.back()));
       }
+      numRounded = roundIndices.size();
 
-      currRoundIndex = leftIndices(minRoundIndex);
-      origValue = xCurr(leftIndices(minRoundIndex));
-      roundValue = std::round(fraction * xCurr(leftIndices(minRoundIndex))) / fraction;
-      //cout<<"origValue,roundValue: "<<origValue<<","<<roundValue<<endl;
-      fixedIndices.conservativeResize(fixedIndices.size() + 1);
-      fixedIndices(fixedIndices.size() - 1) = leftIndices[minRoundIndex];  //is this under-performing?
-      fixedValues.conservativeResize(fixedValues.size() + 1);
-      fixedValues(fixedValues.size() - 1) = roundValue;
-
-      //cout<<"fixedIndices: "<<fixedIndices<<endl;
-      //cout<<"fixedValues: "<<fixedValues<<endl;
+      currRoundIndex = roundIndices[0];
+      origValue = xCurr(currRoundIndex);
+      roundValue = std::round(fraction * origValue) / fraction;
 
-      VectorXi newLeftIndices(leftIndices.size() - 1);
-      newLeftIndices.head(minRoundIndex) = leftIndices.head(minRoundIndex);
-      newLeftIndices.tail(newLeftIndices.size() - minRoundIndex) = leftIndices.tail(newLeftIndices.size() - minRoundIndex);
-      leftIndices = newLeftIndices;
-      //VectorXd JVals;
-      //jacobian(Eigen::VectorXd::Random(UFull.cols()), JVals);
+      int prevNumFixed = fixedIndices.size();
+      fixedIndices.conservativeResize(prevNumFixed + numRounded);
+      fixedValues.conservativeResize(prevNumFixed + numRounded);
+      for (int i = 0; i < numRounded; i++) {
+          fixedIndices(prevNumFixed + i) = roundIndices[i];
+          fixedValues(prevNumFixed + i) = std::round(fraction * xCurr(roundIndices[i])) / fraction;
+      }
 
-      if ((leftIndices.size() == 0) && (!roundSeams) && (!roundedSingularities)) {  //completed rounding singularities;starting to round rest of seams
-          leftIndices = integerIndices;
+      if ((leftHeap.empty()) && (!roundSeams) && (!roundedSingularities)) {  //completed rounding singularities;starting to round rest of seams
+          set_left_indices(integerIndices);
           roundedSingularities = true;
       }
+      numSelections++;
+      selectionTime += timer.getElapsedTimeInSec();
 
-      //Updating fixed elements of the jacobian
-      G2UFullParamLength = G2 * UFull * paramLength;
-
-      //Poisson error
-      gObj = G2UFullParamLength * wPoisson;
-
-      //Closeness
-      igl::speye(xCurrSmall.size(), gClose);
-      gClose = gClose * wClose;  //TODO: bad performance
-
-      //fixedIndices constness
-      gConst.resize(fixedIndices.size(), xCurr.size());
-      vector<Triplet<double>> gConstTriplets;
-      for (int i = 0; i < fixedIndices.size(); i++)
-          gConstTriplets.push_back(Triplet<double>(i, fixedIndices(i), 1.0));
+      timer.start();
+      //fixedIndices constness: only the rows of the new fixed indices are added
+      for (int i = prevNumFixed; i < fixedIndices.size(); i++)
+          for (SparseMatrix<double, RowMajor>::InnerIterator it(UFullRows, fixedIndices(i)); it; ++it)
+              gConstTriplets.push_back(Triplet<double>(i, it.col(), it.value() * wConst));
 
+      gConst.resize(fixedIndices.size(), xCurrSmall.size());
       gConst.setFromTriplets(gConstTriplets.begin(), gConstTriplets.end());
 
-      gConst = gConst * UFull * wConst;
-
-      MatrixXi blockIndices(3, 1);
-      blockIndices << 0, 1, 2;
-      vector<SparseMatrix<double>*> JMats;
-      JMats.push_back(&gObj);
-      JMats.push_back(&gClose);
-      JMats.push_back(&gConst);
-
-      SaddlePoint::sparse_block(blockIndices, JMats, gObjCloseConst);
+      vector<Triplet<double>> JTriplets(gObjCloseTriplets);
+      int constRowOffset = gObj.rows() + gClose.rows();
+      for (int i = 0; i < gConstTriplets.size(); i++)
+          JTriplets.push_back(Triplet<double>(constRowOffset + gConstTriplets[i].row(), gConstTriplets[i].col(), gConstTriplets[i].value()));
+      gObjCloseConst.resize(constRowOffset + gConst.rows(), xCurrSmall.size());
+      gObjCloseConst.setFromTriplets(JTriplets.begin(), JTriplets.end());
 
 
       if (ESize == 0) {
@@ -140,7 +165,8 @@ public:
         ESize = EVec.size();
       }
     
-    return (minRoundDiff>10e-7); //only proceeding if there is a need to round
+    jacobianTime += timer.getElapsedTimeInSec();
+    return (maxRoundDiff>10e-7); //only proceeding if there is a need to round
   }
   
   
@@ -328,16 +354,39 @@ public:
     fixedIndices=VectorXi::Zero(0);
     fixedValues=VectorXd::Zero(0.0);
     
-    if (roundSeams)
-      leftIndices=integerIndices;
-    else
-      leftIndices=singularIndices;
-  
-    
     xCurrSmall=x0Small;
     xPrevSmall=xCurrSmall;
     fraction=1.0;
     
+    xCurr=UFull*xCurrSmall;
+    if (roundSeams)
+      set_left_indices(integerIndices);
+    else
+      set_left_indices(singularIndices);
+    numSelections=numKeyUpdates=0;
+    selectionTime=jacobianTime=0.0;
+    
+    //the fixed elements of the jacobian
+    G2UFullParamLength = G2 * UFull * paramLength;
+    
+    //Poisson error
+    gObj = G2UFullParamLength * wPoisson;
+    
+    //Closeness
+    igl::speye(xCurrSmall.size(), gClose);
+    gClose = gClose * wClose;
+    
+    gObjCloseTriplets.clear();
+    for (int k=0; k<gObj.outerSize(); ++k)
+      for (SparseMatrix<double>::InnerIterator it(gObj,k); it; ++it)
+        gObjCloseTriplets.push_back(Triplet<double>(it.row(), it.col(), it.value()));
+    for (int k=0; k<gClose.outerSize(); ++k)
+      for (SparseMatrix<double>::InnerIterator it(gClose,k); it; ++it)
+        gObjCloseTriplets.push_back(Triplet<double>(gObj.rows()+it.row(), it.col(), it.value()));
+    
+    UFullRows = UFull;
+    gConstTriplets.clear();
+    
   
   }
 };
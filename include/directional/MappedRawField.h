@@ -0,0 +1,154 @@
+// This file is part of Directional, a library for directional field processing.
+// Copyright (C) 2018 Amir Vaxman <avaxman@gmail.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef DIRECTIONAL_MAPPED_RAW_FIELD_H
+#define DIRECTIONAL_MAPPED_RAW_FIELD_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <Eigen/Core>
+#include <igl/igl_inline.h>
+#include <directional/read_binary_raw_field.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace directional
+{
+  // A raw field file in binary format (see read_binary_raw_field.h) that is memory-mapped rather than read.
+  // The field, matching and singularities are exposed as Eigen::Maps into the mapping, so opening the file costs no copy,
+  // and only the pages that are accessed are ever loaded. The maps are valid until the file is closed.
+  // On platforms without mmap the file is read into an owned buffer instead.
+  class MappedRawField
+  {
+  public:
+    typedef Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>> FieldMap;
+    typedef Eigen::Map<const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>> SingleFieldMap;
+    typedef Eigen::Map<const Eigen::Matrix<std::int32_t, Eigen::Dynamic, 1>> IndexMap;
+    
+    BinaryRawFieldHeader header;
+    
+    IGL_INLINE MappedRawField():data(NULL), length(0){}
+    IGL_INLINE ~MappedRawField(){close();}
+    MappedRawField(const MappedRawField&) = delete;
+    MappedRawField& operator=(const MappedRawField&) = delete;
+    
+    // Maps the file. Returns whether the file is a valid binary raw field that can be mapped directly, and rejects files
+    // whose sections exceed the file, are not aligned for their type, or are in the other byte order.
+    IGL_INLINE bool open(const std::string& fileName)
+    {
+      close();
+#ifndef _WIN32
+      int fd = ::open(fileName.c_str(), O_RDONLY);
+      if (fd == -1)
+        return false;
+      struct stat fileStat;
+      if ((fstat(fd, &fileStat) == -1) || (fileStat.st_size < (off_t)sizeof(BinaryRawFieldHeader))){
+        ::close(fd);
+        return false;
+      }
+      length = fileStat.st_size;
+      void* mapping = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+      ::close(fd);
+      if (mapping == MAP_FAILED){
+        length = 0;
+        return false;
+      }
+      data = static_cast<const char*>(mapping);
+#else
+      std::ifstream f(fileName, std::ios::binary | std::ios::ate);
+      if (!f.is_open())
+        return false;
+      buffer.resize(f.tellg());
+      f.seekg(0);
+      f.read(buffer.data(), buffer.size());
+      if (f.fail() || (buffer.size() < sizeof(BinaryRawFieldHeader))){
+        buffer.clear();
+        return false;
+      }
+      data = buffer.data();
+      length = buffer.size();
+#endif
+      std::memcpy(&header, data, sizeof(header));
+      if (header.is_byte_swapped() || !header.is_valid() || !header.fits_in(length)){
+        close();
+        return false;
+      }
+      
+      //the maps require the field and the integer sections to be aligned for their types
+      std::size_t fieldAlignment = (is_single_precision() ? alignof(float) : alignof(double));
+      if ((reinterpret_cast<std::uintptr_t>(data + header.dataOffset) % fieldAlignment != 0) ||
+          (reinterpret_cast<std::uintptr_t>(data + header.matching_offset()) % alignof(std::int32_t) != 0)){
+        close();
+        return false;
+      }
+      return true;
+    }
+    
+    IGL_INLINE void close()
+    {
+#ifndef _WIN32
+      if (data != NULL)
+        munmap(const_cast<char*>(data), length);
+#else
+      buffer.clear();
+#endif
+      data = NULL;
+      length = 0;
+    }
+    
+    IGL_INLINE bool is_open() const {return data != NULL;}
+    IGL_INLINE int N() const {return header.N;}
+    IGL_INLINE Eigen::Index num_faces() const {return header.numF;}
+    IGL_INLINE bool is_single_precision() const {return header.dtype == BINARY_RAW_FIELD_FLOAT;}
+    
+    // #F by 3*N raw field in xyzxyz format (for files in double precision)
+    IGL_INLINE FieldMap raw_field() const
+    {
+      assert(is_open() && !is_single_precision());
+      return FieldMap(reinterpret_cast<const double*>(data + header.dataOffset), header.numF, 3 * header.N);
+    }
+    
+    // #F by 3*N raw field in xyzxyz format (for files in single precision)
+    IGL_INLINE SingleFieldMap raw_field_single() const
+    {
+      assert(is_open() && is_single_precision());
+      return SingleFieldMap(reinterpret_cast<const float*>(data + header.dataOffset), header.numF, 3 * header.N);
+    }
+    
+    // #E matching, empty if not stored
+    IGL_INLINE IndexMap matching() const
+    {
+      return IndexMap(reinterpret_cast<const std::int32_t*>(data + header.matching_offset()), header.numMatching);
+    }
+    
+    // singular vertices and their indices, empty if not stored
+    IGL_INLINE IndexMap sing_vertices() const
+    {
+      return IndexMap(reinterpret_cast<const std::int32_t*>(data + header.singularities_offset()), header.numSingularities);
+    }
+    IGL_INLINE IndexMap sing_indices() const
+    {
+      return IndexMap(reinterpret_cast<const std::int32_t*>(data + header.singularities_offset()) + header.numSingularities, header.numSingularities);
+    }
+    
+  private:
+    const char* data;
+    size_t length;
+#ifdef _WIN32
+    std::vector<char> buffer;
+#endif
+  };
+}
+
+#endif
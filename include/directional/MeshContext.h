@@ -0,0 +1,109 @@
+// This file is part of Directional, a library for directional field processing.
+// Copyright (C) 2018 Amir Vaxman <avaxman@gmail.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef DIRECTIONAL_MESH_CONTEXT_H
+#define DIRECTIONAL_MESH_CONTEXT_H
+
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+#include <igl/igl_inline.h>
+#include <igl/edge_topology.h>
+#include <igl/triangle_triangle_adjacency.h>
+#include <igl/local_basis.h>
+#include <igl/barycenter.h>
+#include <directional/dual_cycles.h>
+
+namespace directional
+{
+  // Cached mesh quantities that most of the library needs (edge topology, face adjacency, local bases, barycenters and the dual-cycle basis).
+  // The mesh itself is immutable after construction, and every other quantity is computed the first time it is requested and then reused,
+  // so that running several algorithms on the same mesh pays for the topology only once.
+  // Every function that takes V,F and recomputes any of these has an overload accepting a MeshContext instead.
+  // Note: the lazy evaluation is not thread-safe; request the needed quantities before sharing a context between threads.
+  class MeshContext
+  {
+  public:
+    const Eigen::MatrixXd V;    // #V by 3 vertex coordinates
+    const Eigen::MatrixXi F;    // #F by 3 face vertex indices
+
+    IGL_INLINE MeshContext(const Eigen::MatrixXd& _V,
+                           const Eigen::MatrixXi& _F):V(_V), F(_F){}
+
+    // igl::edge_topology: #E by 2 edge vertices, #F by 3 face edges, #E by 2 edge faces (-1 on the boundary)
+    IGL_INLINE const Eigen::MatrixXi& EV() const {computeEdgeTopology(); return EVCache;}
+    IGL_INLINE const Eigen::MatrixXi& FE() const {computeEdgeTopology(); return FECache;}
+    IGL_INLINE const Eigen::MatrixXi& EF() const {computeEdgeTopology(); return EFCache;}
+
+    // igl::triangle_triangle_adjacency: #F by 3 adjacent faces (-1 on the boundary)
+    IGL_INLINE const Eigen::MatrixXi& TT() const {computeTT(); return TTCache;}
+
+    // igl::local_basis: #F by 3 orthonormal tangent bases B1, B2 and the face normal B3
+    IGL_INLINE const Eigen::MatrixXd& B1() const {computeLocalBasis(); return B1Cache;}
+    IGL_INLINE const Eigen::MatrixXd& B2() const {computeLocalBasis(); return B2Cache;}
+    IGL_INLINE const Eigen::MatrixXd& B3() const {computeLocalBasis(); return B3Cache;}
+    IGL_INLINE const Eigen::MatrixXd& FN() const {return B3();}
+
+    // #F by 3 face barycenters
+    IGL_INLINE const Eigen::MatrixXd& barycenters() const {computeBarycenters(); return barycentersCache;}
+
+    // directional::dual_cycles (see there for the meaning of each output)
+    IGL_INLINE const Eigen::SparseMatrix<double>& basisCycles() const {computeDualCycles(); return basisCyclesCache;}
+    IGL_INLINE const Eigen::VectorXd& cycleCurvature() const {computeDualCycles(); return cycleCurvatureCache;}
+    IGL_INLINE const Eigen::VectorXi& vertex2cycle() const {computeDualCycles(); return vertex2cycleCache;}
+    IGL_INLINE const Eigen::VectorXi& innerEdges() const {computeDualCycles(); return innerEdgesCache;}
+
+  private:
+    mutable bool hasEdgeTopology=false, hasTT=false, hasLocalBasis=false, hasBarycenters=false, hasDualCycles=false;
+
+    mutable Eigen::MatrixXi EVCache, FECache, EFCache, TTCache;
+    mutable Eigen::MatrixXd B1Cache, B2Cache, B3Cache, barycentersCache;
+    mutable Eigen::SparseMatrix<double> basisCyclesCache;
+    mutable Eigen::VectorXd cycleCurvatureCache;
+    mutable Eigen::VectorXi vertex2cycleCache, innerEdgesCache;
+
+    IGL_INLINE void computeEdgeTopology() const
+    {
+      if (hasEdgeTopology)
+        return;
+      igl::edge_topology(V, F, EVCache, FECache, EFCache);
+      hasEdgeTopology=true;
+    }
+
+    IGL_INLINE void computeTT() const
+    {
+      if (hasTT)
+        return;
+      igl::triangle_triangle_adjacency(F, TTCache);
+      hasTT=true;
+    }
+
+    IGL_INLINE void computeLocalBasis() const
+    {
+      if (hasLocalBasis)
+        return;
+      igl::local_basis(V, F, B1Cache, B2Cache, B3Cache);
+      hasLocalBasis=true;
+    }
+
+    IGL_INLINE void computeBarycenters() const
+    {
+      if (hasBarycenters)
+        return;
+      igl::barycenter(V, F, barycentersCache);
+      hasBarycenters=true;
+    }
+
+    IGL_INLINE void computeDualCycles() const
+    {
+      if (hasDualCycles)
+        return;
+      directional::dual_cycles(V, F, EV(), EF(), basisCyclesCache, cycleCurvatureCache, vertex2cycleCache, innerEdgesCache);
+      hasDualCycles=true;
+    }
+  };
+}
+
+#endif
@@ -0,0 +1,114 @@
+// This file is part of Directional, a library for directional field processing.
+// Copyright (C) 2018 Amir Vaxman <avaxman@gmail.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef DIRECTIONAL_RAW_FIELD_STREAM_READER_H
+#define DIRECTIONAL_RAW_FIELD_STREAM_READER_H
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <fstream>
+#include <Eigen/Core>
+#include <igl/igl_inline.h>
+#include <directional/read_binary_raw_field.h>
+
+namespace directional
+{
+  // Reads a raw field file block by block, so that files that do not fit in memory can be processed face-range by face-range.
+  // Both the text format (read_raw_field) and the binary format (read_binary_raw_field) are accepted, and are told apart by the binary header.
+  // Only one block of rows is held in memory at any time.
+  class RawFieldStreamReader
+  {
+  public:
+    IGL_INLINE RawFieldStreamReader():N(0), numF(0), nextFace(0), isBinary(false), isSinglePrecision(false){}
+    
+    // Opens the file and reads its header. Returns whether the file could be opened and has a valid header.
+    IGL_INLINE bool open(const std::string& fileName)
+    {
+      f.close();
+      f.clear();
+      f.open(fileName, std::ios::binary);
+      if (!f.is_open())
+        return false;
+      
+      nextFace=0;
+      BinaryRawFieldHeader header;
+      if (f.read(reinterpret_cast<char*>(&header), sizeof(header)) && header.is_valid()){
+        isBinary=true;
+        isSinglePrecision=(header.dtype==BINARY_RAW_FIELD_FLOAT);
+        N=header.N;
+        numF=header.numF;
+        f.seekg(header.dataOffset);
+        return true;
+      }
+      
+      isBinary=false;
+      f.clear();
+      f.seekg(0);
+      f>>N;
+      f>>numF;
+      return (!f.fail() && (N>0) && (numF>=0));
+    }
+    
+    IGL_INLINE int get_N() const {return N;}
+    IGL_INLINE Eigen::Index num_faces() const {return numF;}
+    IGL_INLINE bool is_binary() const {return isBinary;}
+    
+    // Reads the next block of at most blockSize faces.
+    // Outputs:
+    //   block:      #B by 3*N rows of the raw field, in xyzxyz format.
+    //   firstFace:  the index of the face of the first row of the block.
+    // Returns:
+    //   false when all faces have been read or on a reading error (then block is empty)
+    IGL_INLINE bool next(const int blockSize,
+                         Eigen::MatrixXd& block,
+                         Eigen::Index& firstFace)
+    {
+      typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> RowMatrixXd;
+      typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> RowMatrixXf;
+      
+      assert(blockSize>0);
+      firstFace=nextFace;
+      Eigen::Index numRows=std::min<Eigen::Index>(blockSize, numF-nextFace);
+      if (!f.is_open() || (numRows<=0)){
+        block.resize(0, 3*N);
+        return false;
+      }
+      
+      if (isBinary){
+        if (isSinglePrecision){
+          RowMatrixXf rowBlock(numRows, 3*N);
+          f.read(reinterpret_cast<char*>(rowBlock.data()), rowBlock.size()*sizeof(float));
+          block=rowBlock.cast<double>();
+        } else {
+          RowMatrixXd rowBlock(numRows, 3*N);
+          f.read(reinterpret_cast<char*>(rowBlock.data()), rowBlock.size()*sizeof(double));
+          block=rowBlock;
+        }
+      } else {
+        block.resize(numRows, 3*N);
+        for (int i=0;i<block.rows();i++)
+          for (int j=0;j<block.cols();j++)
+            f>>block(i,j);
+      }
+      
+      if (f.fail()){
+        block.resize(0, 3*N);
+        return false;
+      }
+      nextFace+=numRows;
+      return true;
+    }
+    
+  private:
+    std::ifstream f;
+    int N;
+    Eigen::Index numF, nextFace;  //the face count of the header is 64 bits
+    bool isBinary, isSinglePrecision;
+  };
+}
+
+#endif
@@ -52,7 +52,7 @@ namespace directional
         // The branch function should be complete under the matching
         assert(
             modulo(faceLevels(0, faceLevels.cols() - 1) + (edgeSigns[0] == 1 ? positiveMatching(edges[0]) : (N - positiveMatching(edges[0]))), N)
-            != faceLevels(0, 0)
+            == faceLevels(0, 0)
         );
 
         
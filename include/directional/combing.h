@@ -10,21 +10,114 @@
 
 
 #include <Eigen/Core>
-#include <queue>
 #include <vector>
+#include <atomic>
+#include <limits>
 #include <cmath>
 #include <igl/igl_inline.h>
 #include <igl/gaussian_curvature.h>
 #include <igl/local_basis.h>
 #include <igl/triangle_triangle_adjacency.h>
 #include <igl/edge_topology.h>
+#include <igl/parallel_for.h>
 #include <directional/tree.h>
 #include <directional/representative_to_raw.h>
 #include <directional/principal_matching.h>
 
 namespace directional
 {
+  // Computes the rotation of every face that makes the matching an identity across the edges of a spanning forest of the dual graph.
+  // Every connected component is traversed from its lowest face, which has turn 0, with a level-synchronous BFS where the faces of each frontier
+  // are expanded in parallel. A face is reached from the first frontier face (and edge) that sees it, so the result is deterministic and independent of the number of threads.
+  // Input:
+  //  EF:        #E x 2 edges to faces indices
+  //  FE:        #F x 3 faces to edges indices
+  //  faceIsCut: #F x 3 edges that must not be crossed, or an empty matrix for none.
+  //  matching:  #E matching function
+  //  N:         The degree of the field
+  // Output:
+  //  faceTurns: #F the index of the vector in each face that becomes the first in the combed field.
+  IGL_INLINE void combing_face_turns(const Eigen::MatrixXi& EF,
+                                     const Eigen::MatrixXi& FE,
+                                     const Eigen::MatrixXi& faceIsCut,
+                                     const Eigen::VectorXi& matching,
+                                     const int N,
+                                     Eigen::VectorXi& faceTurns)
+  {
+    using namespace Eigen;
+    const int numF=FE.rows();
+    const bool hasCuts=(faceIsCut.rows()==numF);
+    faceTurns=VectorXi::Constant(numF,-1);
+    
+    //the lowest key (frontier position*3+edge) of the frontier faces that reach each face in the current level
+    std::vector<std::atomic<int>> claims(numF);
+    for (int i=0;i<numF;i++)
+      claims[i].store(std::numeric_limits<int>::max(), std::memory_order_relaxed);
+    
+    std::vector<int> frontier, nextFrontier;
+    for (int root=0;root<numF;root++){
+      if (faceTurns(root)!=-1)
+        continue;
+      
+      faceTurns(root)=0;
+      frontier.assign(1, root);
+      while (!frontier.empty()){
+        igl::parallel_for(frontier.size(), [&](const int p)
+        {
+          int currFace=frontier[p];
+          for (int i=0;i<3;i++){
+            int edge=FE(currFace,i);
+            int nextFace=(EF(edge,0)==currFace ? EF(edge,1) : EF(edge,0));
+            if ((nextFace==-1)||(faceTurns(nextFace)!=-1)||(hasCuts && faceIsCut(currFace,i)))
+              continue;
+            int key=3*p+i;
+            int prevKey=claims[nextFace].load(std::memory_order_relaxed);
+            while ((key<prevKey)&&(!claims[nextFace].compare_exchange_weak(prevKey, key, std::memory_order_relaxed)));
+          }
+        }, 1000);
+        
+        //the next frontier, ordered by the key that claimed each face
+        nextFrontier.clear();
+        for (int p=0;p<(int)frontier.size();p++)
+          for (int i=0;i<3;i++){
+            int edge=FE(frontier[p],i);
+            int nextFace=(EF(edge,0)==frontier[p] ? EF(edge,1) : EF(edge,0));
+            if ((nextFace!=-1)&&(faceTurns(nextFace)==-1)&&(claims[nextFace].load(std::memory_order_relaxed)==3*p+i))
+              nextFrontier.push_back(nextFace);
+          }
+        
+        igl::parallel_for(nextFrontier.size(), [&](const int q)
+        {
+          int nextFace=nextFrontier[q];
+          int key=claims[nextFace].load(std::memory_order_relaxed);
+          int currFace=frontier[key/3];
+          int edge=FE(currFace,key%3);
+          int nextMatching=(EF(edge,0)==currFace ? matching(edge) : -matching(edge));
+          faceTurns(nextFace)=(nextMatching+faceTurns(currFace)+10*N)%N;  //killing negatives
+        }, 1000);
+        
+        frontier.swap(nextFrontier);
+      }
+    }
+  }
+  
+  // Rotates the vectors of every face, so that vector faceTurns(f) becomes the first (in parallel over the faces).
+  IGL_INLINE void combing_rotate(const Eigen::MatrixXd& rawField,
+                                 const Eigen::VectorXi& faceTurns,
+                                 Eigen::MatrixXd& combedField)
+  {
+    int N=rawField.cols()/3;
+    combedField.resize(rawField.rows(), rawField.cols());
+    igl::parallel_for(rawField.rows(), [&](const int f)
+    {
+      int turn=faceTurns(f);
+      combedField.block(f, 0, 1, 3*(N-turn))=rawField.block(f, 3*turn, 1, 3*(N-turn));
+      combedField.block(f, 3*(N-turn), 1, 3*turn)=rawField.block(f, 0, 1, 3*turn);
+    }, 10000);
+  }
+  
   // Reorders the vectors in a face (preserving CCW) so that the prescribed matching across most edges, except a small set (called a cut), is an identity, making it ready for cutting and parameterization.
+  // Every connected component of the mesh is combed separately.
   // Important: if the Raw field in not CCW ordered, the result is unpredictable.
   // Input:
   //  V:        #V x 3 vertex coordinates
@@ -35,45 +128,18 @@ namespace directional
   //  matching: #E matching function, where vector k in EF(i,0) matches to vector (k+matching(k))%N in EF(i,1). In case of boundary, there is a -1.
   // Output:
   //  combedField: #F by 3*N reindexed field
-  IGL_INLINE void combing(const Eigen::MatrixXd& V,
-                          const Eigen::MatrixXi& F,
-                          const Eigen::MatrixXi& EV,
+  IGL_INLINE void combing(const Eigen::MatrixXd& /*V*/,
+                          const Eigen::MatrixXi& /*F*/,
+                          const Eigen::MatrixXi& /*EV*/,
                           const Eigen::MatrixXi& EF,
                           const Eigen::MatrixXi& FE,
                           const Eigen::MatrixXd& rawField,
                           const Eigen::VectorXi& matching,
                           Eigen::MatrixXd& combedField)
   {
-    using namespace Eigen;
-    //flood-filling through the matching to comb field
-    combedField.conservativeResize(rawField.rows(), rawField.cols());
-    int N=rawField.cols()/3;
-    //dual tree to find combing routes
-    VectorXi visitedFaces=VectorXi::Constant(F.rows(),1,0);
-    std::queue<std::pair<int,int> > faceMatchingQueue;
-    faceMatchingQueue.push(std::pair<int,int>(0,0));
-    do{
-      std::pair<int,int> currFaceMatching=faceMatchingQueue.front();
-      faceMatchingQueue.pop();
-      if (visitedFaces(currFaceMatching.first))
-        continue;
-      visitedFaces(currFaceMatching.first)=1;
-      
-      //combing field to start from the matching index
-      combedField.block(currFaceMatching.first, 0, 1, 3*(N-currFaceMatching.second))=rawField.block(currFaceMatching.first, 3*currFaceMatching.second, 1, 3*(N-currFaceMatching.second));
-      combedField.block(currFaceMatching.first, 3*(N-currFaceMatching.second), 1, 3*currFaceMatching.second)=rawField.block(currFaceMatching.first, 0, 1, 3*currFaceMatching.second);
-      
-      for (int i=0;i<3;i++){
-        int nextMatching=(matching(FE(currFaceMatching.first,i)));
-        int nextFace=(EF(FE(currFaceMatching.first,i),0)==currFaceMatching.first ? EF(FE(currFaceMatching.first,i),1) : EF(FE(currFaceMatching.first,i),0));
-        nextMatching*=(EF(FE(currFaceMatching.first,i),0)==currFaceMatching.first ? 1.0 : -1.0);
-        nextMatching=(nextMatching+currFaceMatching.second+10*N)%N;  //killing negatives
-        if ((nextFace!=-1)&&(!visitedFaces(nextFace)))
-          faceMatchingQueue.push(std::pair<int,int>(nextFace, nextMatching));
-        
-      }
-      
-    }while (!faceMatchingQueue.empty());
+    Eigen::VectorXi faceTurns;
+    combing_face_turns(EF, FE, Eigen::MatrixXi(), matching, rawField.cols()/3, faceTurns);
+    combing_rotate(rawField, faceTurns, combedField);
   }
   
   //version for input in representative format (for N-RoSy directionals).
@@ -93,9 +159,9 @@ namespace directional
   }
   
   //version with prescribed cuts from faces
-  IGL_INLINE void combing(const Eigen::MatrixXd& V,
-                          const Eigen::MatrixXi& F,
-                          const Eigen::MatrixXi& EV,
+  IGL_INLINE void combing(const Eigen::MatrixXd& /*V*/,
+                          const Eigen::MatrixXi& /*F*/,
+                          const Eigen::MatrixXi& /*EV*/,
                           const Eigen::MatrixXi& EF,
                           const Eigen::MatrixXi& FE,
                           const Eigen::MatrixXi& faceIsCut,
@@ -105,39 +171,11 @@ namespace directional
                           Eigen::VectorXi& combedMatching)
   {
     using namespace Eigen;
-    //flood-filling through the matching to comb field
-    combedField.conservativeResize(rawField.rows(), rawField.cols());
-    combedMatching.conservativeResize(EF.rows());
     int N=rawField.cols()/3;
-    //dual tree to find combing routes
-    VectorXi visitedFaces=VectorXi::Constant(F.rows(),1,0);
-    std::queue<std::pair<int,int> > faceMatchingQueue;
-    faceMatchingQueue.push(std::pair<int,int>(0,0));
-    VectorXi faceTurns(rawField.rows());
-    do{
-      std::pair<int,int> currFaceMatching=faceMatchingQueue.front();
-      faceMatchingQueue.pop();
-      if (visitedFaces(currFaceMatching.first))
-        continue;
-      visitedFaces(currFaceMatching.first)=1;
-      
-      //combing field to start from the matching index
-      combedField.block(currFaceMatching.first, 0, 1, 3*(N-currFaceMatching.second))=rawField.block(currFaceMatching.first, 3*currFaceMatching.second, 1, 3*(N-currFaceMatching.second));
-      combedField.block(currFaceMatching.first, 3*(N-currFaceMatching.second), 1, 3*currFaceMatching.second)=rawField.block(currFaceMatching.first, 0, 1, 3*currFaceMatching.second);
-      
-      faceTurns(currFaceMatching.first)=currFaceMatching.second;
-      
-      for (int i=0;i<3;i++){
-        int nextMatching=(matching(FE(currFaceMatching.first,i)));
-        int nextFace=(EF(FE(currFaceMatching.first,i),0)==currFaceMatching.first ? EF(FE(currFaceMatching.first,i),1) : EF(FE(currFaceMatching.first,i),0));
-        nextMatching*=(EF(FE(currFaceMatching.first,i),0)==currFaceMatching.first ? 1.0 : -1.0);
-        nextMatching=(nextMatching+currFaceMatching.second+10*N)%N;  //killing negatives
-        if ((nextFace!=-1)&&(!visitedFaces(nextFace))&&(!faceIsCut(currFaceMatching.first,i)))
-          faceMatchingQueue.push(std::pair<int,int>(nextFace, nextMatching));
-        
-      }
-      
-    }while (!faceMatchingQueue.empty());
+    VectorXi faceTurns;
+    combing_face_turns(EF, FE, faceIsCut, matching, N, faceTurns);
+    combing_rotate(rawField, faceTurns, combedField);
+    combedMatching.conservativeResize(EF.rows());
     
     //giving combed matching
     for (int i=0;i<EF.rows();i++){
@@ -9,12 +9,16 @@
 #include <directional/conjugate_frame_fields.h>
 #include <igl/speye.h>
 #include <igl/slice.h>
-#include <directional/polyroots.h>
+#include <igl/parallel_for.h>
+#include <igl/Timer.h>
 #include <directional/polyvector_to_raw.h>
+#include <directional/polynomial_roots.h>
 #include <directional/ccw_reorient_field.h>
 #include <Eigen/Sparse>
 
 #include <iostream>
+#include <vector>
+#include <algorithm>
 
 namespace directional {
   class ConjugateFFSolver
@@ -30,6 +34,9 @@ namespace directional {
                             const Eigen::MatrixXd &initialSolution,
                             Eigen::MatrixXd &output);
     
+    //timing of the local and global steps (in seconds) of every iteration of the last solve
+    std::vector<double> localStepTimes, globalStepTimes;
+    
   private:
     
     const ConjugateFFSolverData &data;
@@ -48,7 +55,10 @@ namespace directional {
     IGL_INLINE void localStep();
     IGL_INLINE void getPolyCoeffsForLocalSolve(const Eigen::Matrix<double, 4, 1> &s,
                                                const Eigen::Matrix<double, 4, 1> &z,
-                                               Eigen::Matrix<double, Eigen::Dynamic, 1> &polyCoeff);
+                                               Eigen::Matrix<double, 7, 1> &polyCoeff);
+    IGL_INLINE void biquadraticRoots(const std::complex<double> &A,
+                                     const std::complex<double> &B,
+                                     Eigen::Matrix<std::complex<double>, 4, 1> &roots);
     
     IGL_INLINE void globalStep(const Eigen::Matrix<int, Eigen::Dynamic, 1>  &isConstrained,
                                const Eigen::Matrix<std::complex<double>, Eigen::Dynamic, 1>  &Ak,
@@ -90,7 +100,7 @@ doHardConstraints(_doHardConstraints)
 IGL_INLINE void directional::ConjugateFFSolver::
 getPolyCoeffsForLocalSolve(const Eigen::Matrix<double, 4, 1> &s,
                            const Eigen::Matrix<double, 4, 1> &z,
-                           Eigen::Matrix<double, Eigen::Dynamic, 1> &polyCoeff)
+                           Eigen::Matrix<double, 7, 1> &polyCoeff)
 {
   double s0 = s(0);
   double s1 = s(1);
@@ -101,7 +111,6 @@ getPolyCoeffsForLocalSolve(const Eigen::Matrix<double, 4, 1> &s,
   double z2 = z(2);
   double z3 = z(3);
   
-  polyCoeff.resize(7,1);
   polyCoeff(0) =  s0*s0* s1*s1* s2*s2* s3* z3*z3 +  s0*s0* s1*s1* s2* s3*s3* z2*z2 +  s0*s0* s1* s2*s2* s3*s3* z1*z1 +  s0* s1*s1* s2*s2* s3*s3* z0*z0 ;
   polyCoeff(1) = 2* s0*s0* s1*s1* s2* s3* z2*z2 + 2* s0*s0* s1*s1* s2* s3* z3*z3 + 2* s0*s0* s1* s2*s2* s3* z1*z1 + 2* s0*s0* s1* s2*s2* s3* z3*z3 + 2* s0*s0* s1* s2* s3*s3* z1*z1 + 2* s0*s0* s1* s2* s3*s3* z2*z2 + 2* s0* s1*s1* s2*s2* s3* z0*z0 + 2* s0* s1*s1* s2*s2* s3* z3*z3 + 2* s0* s1*s1* s2* s3*s3* z0*z0 + 2* s0* s1*s1* s2* s3*s3* z2*z2 + 2* s0* s1* s2*s2* s3*s3* z0*z0 + 2* s0* s1* s2*s2* s3*s3* z1*z1 ;
   polyCoeff(2) =  s0*s0* s1*s1* s2* z2*z2 +  s0*s0* s1*s1* s3* z3*z3 +  s0*s0* s1* s2*s2* z1*z1 + 4* s0*s0* s1* s2* s3* z1*z1 + 4* s0*s0* s1* s2* s3* z2*z2 + 4* s0*s0* s1* s2* s3* z3*z3 +  s0*s0* s1* s3*s3* z1*z1 +  s0*s0* s2*s2* s3* z3*z3 +  s0*s0* s2* s3*s3* z2*z2 +  s0* s1*s1* s2*s2* z0*z0 + 4* s0* s1*s1* s2* s3* z0*z0 + 4* s0* s1*s1* s2* s3* z2*z2 + 4* s0* s1*s1* s2* s3* z3*z3 +  s0* s1*s1* s3*s3* z0*z0 + 4* s0* s1* s2*s2* s3* z0*z0 + 4* s0* s1* s2*s2* s3* z1*z1 + 4* s0* s1* s2*s2* s3* z3*z3 + 4* s0* s1* s2* s3*s3* z0*z0 + 4* s0* s1* s2* s3*s3* z1*z1 + 4* s0* s1* s2* s3*s3* z2*z2 +  s0* s2*s2* s3*s3* z0*z0 +  s1*s1* s2*s2* s3* z3*z3 +  s1*s1* s2* s3*s3* z2*z2 +  s1* s2*s2* s3*s3* z1*z1;
@@ -115,19 +124,17 @@ getPolyCoeffsForLocalSolve(const Eigen::Matrix<double, 4, 1> &s,
 
 IGL_INLINE void directional::ConjugateFFSolver::localStep()
 {
-  for (int j =0; j<data.numF; ++j)
+  igl::parallel_for(data.numF, [&](const int j)
   {
     Eigen::Matrix<double, 4, 1> xproj; xproj << pvU.row(j).transpose(),pvV.row(j).transpose();
     Eigen::Matrix<double, 4, 1> z = data.UH[j].transpose()*xproj;
     Eigen::Matrix<double, 4, 1> x;
     
-    Eigen::Matrix<double, Eigen::Dynamic, 1> polyCoeff;
+    Eigen::Matrix<double, 7, 1> polyCoeff;
     getPolyCoeffsForLocalSolve(data.s[j], z, polyCoeff);
-    Eigen::Matrix<std::complex<double>, Eigen::Dynamic, 1> roots;
-    
-    //directional::polyvector_to_raw(data.B1(j),data.B2(j), polyCoeff,4,roots);
-    
-    igl::polyRoots<double, double> (polyCoeff, roots);
+    Eigen::Matrix<std::complex<double>, 6, 1> roots;
+    Eigen::Matrix<double, 6, 1> monicCoeff = polyCoeff.tail<6>().reverse()/polyCoeff(0);
+    directional::polynomial_roots<6, double>(monicCoeff, roots);
     
     //  find closest real root to xproj
     double minDist = 1e10;
@@ -148,19 +155,19 @@ IGL_INLINE void directional::ConjugateFFSolver::localStep()
     
     pvU.row(j) << x(0),x(1);
     pvV.row(j) << x(2),x(3);
-  }
+  }, 1000);
 }
 
 
 IGL_INLINE void directional::ConjugateFFSolver::setCoefficientsFromField()
 {
-  for (int i = 0; i <data.numF; ++i)
+  igl::parallel_for(data.numF, [&](const int i)
   {
     std::complex<double> u(pvU(i,0),pvU(i,1));
     std::complex<double> v(pvV(i,0),pvV(i,1));
     Acoeff(i) = u*u+v*v;
     Bcoeff(i) = u*u*v*v;
-  }
+  }, 1000);
 }
 
 
@@ -195,17 +202,27 @@ IGL_INLINE void directional::ConjugateFFSolver::globalStep(const Eigen::Matrix<i
 }
 
 
+//roots of x^4-Ax^2+B in closed form (x^2 solves a quadratic), sorted by arg as in igl::polyRoots
+IGL_INLINE void directional::ConjugateFFSolver::biquadraticRoots(const std::complex<double> &A,
+                                                                 const std::complex<double> &B,
+                                                                 Eigen::Matrix<std::complex<double>, 4, 1> &roots)
+{
+  Eigen::Matrix<std::complex<double>, 2, 1> squareCoeffs(B, -A), squareRoots;
+  directional::polynomial_roots<2, std::complex<double> >(squareCoeffs, squareRoots);
+  std::complex<double> a = sqrt(squareRoots(0));
+  std::complex<double> b = sqrt(squareRoots(1));
+  roots << a, -a, b, -b;
+  std::sort(roots.data(), roots.data() + roots.size(), [](std::complex<double> r1, std::complex<double> r2){return arg(r1) < arg(r2);});
+}
+
+
 IGL_INLINE void directional::ConjugateFFSolver::setFieldFromCoefficients()
 {
-  for (int i = 0; i <data.numF; ++i)
+  igl::parallel_for(data.numF, [&](const int i)
   {
     //    poly coefficients: 1, 0, -Acoeff, 0, Bcoeff
-    //    matlab code from roots (given there are no trailing zeros in the polynomial coefficients)
-    Eigen::Matrix<std::complex<double>, Eigen::Dynamic, 1> polyCoeff(5,1);
-    polyCoeff<<1., 0., -Acoeff(i), 0., Bcoeff(i);
-    
-    Eigen::Matrix<std::complex<double>, Eigen::Dynamic, 1> roots;
-    igl::polyRoots<std::complex<double> >(polyCoeff,roots);
+    Eigen::Matrix<std::complex<double>, 4, 1> roots;
+    biquadraticRoots(Acoeff(i), Bcoeff(i), roots);
     
     std::complex<double> u = roots[0];
     int maxi = -1;
@@ -222,7 +239,7 @@ IGL_INLINE void directional::ConjugateFFSolver::setFieldFromCoefficients()
     std::complex<double> v = roots[maxi];
     pvU(i,0) = real(u); pvU(i,1) = imag(u);
     pvV(i,0) = real(v); pvV(i,1) = imag(v);
-  }
+  }, 1000);
   
 }
 
@@ -341,14 +358,22 @@ IGL_INLINE double directional::ConjugateFFSolver::solve(const Eigen::VectorXi &i
   lambda = lambdaInit;
   
   bool doit = false;
+  localStepTimes.clear();
+  globalStepTimes.clear();
+  igl::Timer timer;
   for (int iter = 0; iter<maxIter; ++iter)
   {
     printf("\n\n--- Iteration %d ---\n",iter);
     
     double oldMeanConj = meanConj;
     
+    timer.start();
     localStep();
+    localStepTimes.push_back(timer.getElapsedTimeInSec());
+    timer.start();
     globalStep(isConstrained, Ak, Bk);
+    globalStepTimes.push_back(timer.getElapsedTimeInSec());
+    printf("Local/global step time: %.5g, %.5g s\n",localStepTimes.back(),globalStepTimes.back());
     
     
     smoothnessValue = (Acoeff.adjoint()*data.DDA*Acoeff + Bcoeff.adjoint()*data.DDB*Bcoeff).real()[0];
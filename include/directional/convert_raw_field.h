@@ -0,0 +1,57 @@
+// This file is part of Directional, a library for directional field processing.
+// Copyright (C) 2018 Amir Vaxman <avaxman@gmail.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef DIRECTIONAL_CONVERT_RAW_FIELD_H
+#define DIRECTIONAL_CONVERT_RAW_FIELD_H
+
+#include <string>
+#include <Eigen/Core>
+#include <igl/igl_inline.h>
+#include <directional/read_raw_field.h>
+#include <directional/write_raw_field.h>
+#include <directional/read_binary_raw_field.h>
+#include <directional/write_binary_raw_field.h>
+
+namespace directional
+{
+  // Converts a raw field file from the text format to the binary format
+  // Inputs:
+  //   textFileName:    The text raw field file
+  //   binaryFileName:  The binary file to be written
+  //   singlePrecision: if true the field is stored in single precision
+  // Returns:
+  //   Whether or not the conversion was successful
+  bool IGL_INLINE raw_field_text_to_binary(const std::string& textFileName,
+                                           const std::string& binaryFileName,
+                                           bool singlePrecision = false)
+  {
+    int N;
+    Eigen::MatrixXd rawField;
+    if (!read_raw_field(textFileName, N, rawField))
+      return false;
+    return write_binary_raw_field(binaryFileName, rawField, singlePrecision);
+  }
+  
+  // Converts a raw field file from the binary format to the text format. The matching and singularities, if stored, are not converted.
+  // Inputs:
+  //   binaryFileName:  The binary raw field file
+  //   textFileName:    The text file to be written
+  //   high_precision:  as in write_raw_field()
+  // Returns:
+  //   Whether or not the conversion was successful
+  bool IGL_INLINE raw_field_binary_to_text(const std::string& binaryFileName,
+                                           const std::string& textFileName,
+                                           bool high_precision = true)
+  {
+    int N;
+    Eigen::MatrixXd rawField;
+    if (!read_binary_raw_field(binaryFileName, N, rawField))
+      return false;
+    return write_raw_field(textFileName, rawField, high_precision);
+  }
+}
+
+#endif
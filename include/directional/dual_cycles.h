@@ -15,6 +15,7 @@
 #include <igl/slice.h>
 #include <igl/unique.h>
 #include <igl/edge_topology.h>
+#include <igl/parallel_for.h>
 #include <vector>
 #include <set>
 #include <unordered_map>
@@ -69,8 +70,8 @@ namespace directional
     
     //Creating boundary cycles by building a matrix the sums up boundary loops and zeros out boundary vertex cycles - it will be multiplied from the left to basisCyclesMat
     VectorXi isBoundary(V.rows()); isBoundary.setZero();
-    for (int i=0;i<boundaryLoops.size();i++)
-      for (int j=0;j<boundaryLoops[i].size();j++)
+    for (int i=0;i<(int)boundaryLoops.size();i++)
+      for (int j=0;j<(int)boundaryLoops[i].size();j++)
         isBoundary(boundaryLoops[i][j])=1;
     
     VectorXi pureInnerEdgeMask=VectorXi::Constant(EV.rows(),1);
@@ -108,7 +109,6 @@ namespace directional
           dualTreeFathers(i) = inFullIndices(dualTreeFathers(i));
       
       //building tree co-tree based homological cycles
-      //finding dual edge which are not in the tree, and following their faces to the end
       VectorXi isinTree = VectorXi::Zero(EF.rows());
       for (int i = 0; i < dualTreeEdges.size(); i++) {
         isinTree(dualTreeEdges(i)) = 1;
@@ -117,53 +117,77 @@ namespace directional
         isinTree(primalTreeEdges(i)) = 1;
       }
       
-      for (int i = 0; i < isinTree.size(); i++) {
-        if (isinTree(i))
-          continue;
+      //depth of every face in the dual tree (the tree edges are in BFS order, so fathers come before their children)
+      VectorXi faceDepth = VectorXi::Constant(dualTreeFathers.size(), -1);
+      for (int i = 0; i < dualTreeFathers.size(); i++)
+        if (dualTreeFathers(i) == -1)
+          faceDepth(i) = 0;
+      for (int i = 0; i < dualTreeEdges.size(); i++) {
+        int e = dualTreeEdges(i);
+        int child = (dualTreeFathers(EF(e, 0)) == e ? EF(e, 0) : EF(e, 1));
+        int father = (child == EF(e, 0) ? EF(e, 1) : EF(e, 0));
+        faceDepth(child) = faceDepth(father) + 1;
+      }
+      
+      std::vector<int> cycleEdges;
+      for (int i = 0; i < isinTree.size(); i++)
+        if ((!isinTree(i)) && (EF(i, 0) != -1) && (EF(i, 1) != -1))
+          cycleEdges.push_back(i);
+      
+      //finding dual edge which are not in the tree, and following their faces up to their lowest common ancestor; this is the dual cycle.
+      //The cycles are independent, and are generated in parallel.
+      std::vector<std::vector<Triplet<double> > > cycleTriplets(cycleEdges.size());
+      std::vector<int> isBoundaryCycle(cycleEdges.size(), 1);
+      igl::parallel_for(cycleEdges.size(), [&](const int c)
+      {
+        int i = cycleEdges[c];
+        int currFaces[2] = {EF(i, 0), EF(i, 1)};
+        bool inTree[2];
+        for (int leaf = 0; leaf < 2; leaf++)
+          inTree[leaf] = (currFaces[leaf] < dualTreeFathers.size()) && (dualTreeFathers(currFaces[leaf]) != -2);
+        if (!inTree[0])
+          return;
         
-        //std::cout<<"New Cycle"<<std::endl;
-        //otherwise, follow both end faces to the root and this is the dual cycle
-        if (EF(i, 0) == -1 || EF(i, 1) == -1)
-          continue;
-        std::vector<Triplet<double> > candidateTriplets;
-        //candidateTriplets.push_back(Triplet<double>(0, i, 1.0));
-        Vector2i currLeaves; currLeaves << EF(i, 0), EF(i, 1);
-        VectorXi visitedOnce = VectorXi::Zero(EF.rows());  //used to remove the tail from the LCA to the root
-        bool isBoundaryCycle=true;
-        for (int i = 0; i < 2; i++) { //on leaves
-          int currTreeEdge = -1;  //indexing within dualTreeEdges
-          int currFace = currLeaves(i);
-          currTreeEdge = dualTreeFathers(currFace);
-          if (currTreeEdge == -2)
-          {
-            break;
-          }
-
-          while (currTreeEdge != -1) {
-            //std::cout<<"currTreeEdge: "<<currTreeEdge<<"\n"<<std::endl;
-            //determining orientation of current edge vs. face
-            double sign = ((EF(currTreeEdge, 0) == currFace) != (i == 0) ? 1.0 : -1.0);
-            visitedOnce(currTreeEdge) = 1 - visitedOnce(currTreeEdge);
-            candidateTriplets.push_back(Triplet<double>(0, currTreeEdge, sign));
-            currFace = (EF(currTreeEdge, 0) == currFace ? EF(currTreeEdge, 1) : EF(currTreeEdge, 0));
-            currTreeEdge = dualTreeFathers(currFace);
+        //paths from each leaf, ordered from the leaf up
+        std::vector<Triplet<double> > paths[2];
+        auto climb = [&](const int leaf)
+        {
+          int currTreeEdge = dualTreeFathers(currFaces[leaf]);
+          //determining orientation of current edge vs. face
+          double sign = ((EF(currTreeEdge, 0) == currFaces[leaf]) != (leaf == 0) ? 1.0 : -1.0);
+          paths[leaf].push_back(Triplet<double>(0, currTreeEdge, sign));
+          currFaces[leaf] = (EF(currTreeEdge, 0) == currFaces[leaf] ? EF(currTreeEdge, 1) : EF(currTreeEdge, 0));
+        };
+        
+        if (!inTree[1]) {  //the whole path to the root
+          while (dualTreeFathers(currFaces[0]) != -1)
+            climb(0);
+        } else {
+          while (faceDepth(currFaces[0]) > faceDepth(currFaces[1]))
+            climb(0);
+          while (faceDepth(currFaces[1]) > faceDepth(currFaces[0]))
+            climb(1);
+          while (currFaces[0] != currFaces[1]) {
+            climb(0);
+            climb(1);
           }
         }
-
-        //only putting in dual edges that are below the LCA
-        for (int i=0;i<candidateTriplets.size();i++)
-          if ((visitedOnce(candidateTriplets[i].col()))&&(pureInnerEdgeMask(candidateTriplets[i].col())))
-            isBoundaryCycle=false;
-        
-        int currRow = (isBoundaryCycle ? numV+currBoundaryCycle : numV+numBoundaries+currGeneratorCycle);
-        (isBoundaryCycle ? currBoundaryCycle++ : currGeneratorCycle++);
         
-        basisCycleTriplets.push_back(Triplet<double>(currRow, i, 1.0));
-        for (size_t i = 0; i < candidateTriplets.size(); i++)
-          if (visitedOnce(candidateTriplets[i].col())){
-            Triplet<double> trueTriplet(currRow,candidateTriplets[i].col(), candidateTriplets[i].value());
-            basisCycleTriplets.push_back(trueTriplet);
+        for (int leaf = 0; leaf < 2; leaf++)
+          for (size_t j = 0; j < paths[leaf].size(); j++) {
+            cycleTriplets[c].push_back(paths[leaf][j]);
+            if (pureInnerEdgeMask(paths[leaf][j].col()))
+              isBoundaryCycle[c] = 0;
           }
+      }, 100);
+      
+      for (int c = 0; c < (int)cycleEdges.size(); c++) {
+        int currRow = (isBoundaryCycle[c] ? numV+currBoundaryCycle : numV+numBoundaries+currGeneratorCycle);
+        (isBoundaryCycle[c] ? currBoundaryCycle++ : currGeneratorCycle++);
+        
+        basisCycleTriplets.push_back(Triplet<double>(currRow, cycleEdges[c], 1.0));
+        for (size_t j = 0; j < cycleTriplets[c].size(); j++)
+          basisCycleTriplets.push_back(Triplet<double>(currRow, cycleTriplets[c][j].col(), cycleTriplets[c][j].value()));
       }
       //assert(currBoundaryCycle==numBoundaries && currGeneratorCycle==numGenerators);
     }
@@ -186,8 +210,8 @@ namespace directional
         innerEdgesList.push_back(i);
     
     //summing up boundary loops
-    for (int i=0;i<boundaryLoops.size();i++)
-      for (int j=0;j<boundaryLoops[i].size();j++){
+    for (int i=0;i<(int)boundaryLoops.size();i++)
+      for (int j=0;j<(int)boundaryLoops[i].size();j++){
         sumBoundaryLoopsTriplets.push_back(Triplet<double>(numV+i, boundaryLoops[i][j],1.0));
         vertex2cycle(boundaryLoops[i][j])=innerVerticesList.size()+i;
       }
@@ -206,13 +230,13 @@ namespace directional
     //removing rows and columns
     remainRows.resize(innerVerticesList.size()+numBoundaries+numGenerators);
     remainColumns.resize(innerEdgesList.size());
-    for (int i=0;i<innerVerticesList.size();i++)
+    for (int i=0;i<(int)innerVerticesList.size();i++)
       remainRows(i)=innerVerticesList[i];
     
     for (int i=0;i<numBoundaries+numGenerators;i++)
       remainRows(innerVerticesList.size()+i)=numV+i;
     
-    for (int i=0;i<innerEdgesList.size();i++)
+    for (int i=0;i<(int)innerEdgesList.size();i++)
       remainColumns(i)=innerEdgesList[i];
     
     //creating slicing matrices
@@ -231,13 +255,10 @@ namespace directional
     basisCycles=rowSliceMat*basisCycles*colSliceMat;
     
     innerEdges.conservativeResize(innerEdgesList.size());
-    for (int i=0;i<innerEdgesList.size();i++)
+    for (int i=0;i<(int)innerEdgesList.size();i++)
       innerEdges(i)=innerEdgesList[i];
     
     //computing cycle curvatures
-    Eigen::MatrixXd B1, B2, B3;
-    igl::local_basis(V, F, B1, B2, B3);
-    
     //Correct computation of cycle curvature by adding angles
     //getting corner angle sum
     VectorXd allAngles(3*F.rows());
@@ -282,7 +303,7 @@ namespace directional
         vertexSets[it.row()].insert(EV(innerEdges(it.col()), it.value()<0 ? 0 : 1));
       }
     
-    for (int i=0;i<cornerSets.size();i++){
+    for (int i=0;i<(int)cornerSets.size();i++){
       if (isBigCycle(i))
         cycleCurvature(i)=igl::PI*(double)(vertexSets[i].size());
       else
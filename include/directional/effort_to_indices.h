@@ -17,6 +17,7 @@
 #include <igl/per_face_normals.h>
 #include <igl/parallel_transport_angles.h>
 #include <directional/dual_cycles.h>
+#include <directional/MeshContext.h>
 
 
 namespace directional
@@ -47,35 +48,37 @@ namespace directional
   }
   
   
-  // minimal version without precomputed cycles or inner edges, returning only vertex singularities
-  IGL_INLINE void effort_to_indices(const Eigen::MatrixXd& V,
-                                    const Eigen::MatrixXi& F,
-                                    const Eigen::MatrixXi& EV,
-                                    const Eigen::MatrixXi& EF,
+  // Version with precomputed cycles that takes the effort on all edges, returning only vertex singularities
+  // Input:
+  //  basisCycles, cycleCurvature, vertex2cycle, innerEdges: as computed by directional::dual_cycles
+  //  effort:         #E the effort on all edges.
+  //  N:              The degree of the field
+  // Output:
+  //  singVertices:   the vertices with nonzero index
+  //  singIndices:    their indices (x N)
+  IGL_INLINE void effort_to_indices(const Eigen::SparseMatrix<double>& basisCycles,
+                                    const Eigen::VectorXd& cycleCurvature,
+                                    const Eigen::VectorXi& vertex2cycle,
+                                    const Eigen::VectorXi& innerEdges,
                                     const Eigen::VectorXd& effort,
                                     const Eigen::VectorXi& matching,
                                     const int N,
                                     Eigen::VectorXi& singVertices,
                                     Eigen::VectorXi& singIndices)
   {
-    Eigen::SparseMatrix<double> basisCycles;
-    Eigen::VectorXd cycleCurvature;
-    Eigen::VectorXi vertex2cycle;
-    Eigen::VectorXi innerEdges;
-    directional::dual_cycles(V, F,EV, EF, basisCycles, cycleCurvature, vertex2cycle, innerEdges);
     Eigen::VectorXd effortInner(innerEdges.size());
     for (int i=0;i<innerEdges.size();i++)
       effortInner(i)=effort(innerEdges(i));
     Eigen::VectorXi fullIndices;
     directional::effort_to_indices(basisCycles, effortInner, matching, cycleCurvature, N, fullIndices);
    
-    Eigen::VectorXi indices(V.rows());
-    for (int i=0;i<V.rows();i++)
+    Eigen::VectorXi indices(vertex2cycle.size());
+    for (int i=0;i<vertex2cycle.size();i++)
       indices(i)=fullIndices(vertex2cycle(i));
   
     std::vector<int> singVerticesList;
     std::vector<int> singIndicesList;
-    for (int i=0;i<V.rows();i++)
+    for (int i=0;i<vertex2cycle.size();i++)
       if (indices(i)!=0){
         singVerticesList.push_back(i);
         singIndicesList.push_back(indices(i));
@@ -88,6 +91,36 @@ namespace directional
       singIndices(i)=singIndicesList[i];
     }
   }
+  
+  // minimal version without precomputed cycles or inner edges, returning only vertex singularities
+  IGL_INLINE void effort_to_indices(const Eigen::MatrixXd& V,
+                                    const Eigen::MatrixXi& F,
+                                    const Eigen::MatrixXi& EV,
+                                    const Eigen::MatrixXi& EF,
+                                    const Eigen::VectorXd& effort,
+                                    const Eigen::VectorXi& matching,
+                                    const int N,
+                                    Eigen::VectorXi& singVertices,
+                                    Eigen::VectorXi& singIndices)
+  {
+    Eigen::SparseMatrix<double> basisCycles;
+    Eigen::VectorXd cycleCurvature;
+    Eigen::VectorXi vertex2cycle;
+    Eigen::VectorXi innerEdges;
+    directional::dual_cycles(V, F,EV, EF, basisCycles, cycleCurvature, vertex2cycle, innerEdges);
+    effort_to_indices(basisCycles, cycleCurvature, vertex2cycle, innerEdges, effort, matching, N, singVertices, singIndices);
+  }
+  
+  // minimal version returning only vertex singularities, with the dual cycles taken from a MeshContext
+  IGL_INLINE void effort_to_indices(const MeshContext& mesh,
+                                    const Eigen::VectorXd& effort,
+                                    const Eigen::VectorXi& matching,
+                                    const int N,
+                                    Eigen::VectorXi& singVertices,
+                                    Eigen::VectorXi& singIndices)
+  {
+    effort_to_indices(mesh.basisCycles(), mesh.cycleCurvature(), mesh.vertex2cycle(), mesh.innerEdges(), effort, matching, N, singVertices, singIndices);
+  }
 }
 
 #endif
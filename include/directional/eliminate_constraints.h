@@ -0,0 +1,182 @@
+// This file is part of Directional, a library for directional field processing.
+// Copyright (C) 2021 Amir Vaxman <avaxman@gmail.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef DIRECTIONAL_ELIMINATE_CONSTRAINTS_H
+#define DIRECTIONAL_ELIMINATE_CONSTRAINTS_H
+
+#include <vector>
+#include <cmath>
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+#include <igl/igl_inline.h>
+
+namespace directional
+{
+  // Eliminates homogeneous linear constraints C*x=0 into a reduced basis x=U*y, so that quadratic energies can be minimized under the constraints as unconstrained (SPD) problems in y.
+  // Every row of C is expressed in the variables that are still free, and one of them (the pivot) is solved for and eliminated. Rows that vanish are linearly dependent on the previous ones and are skipped.
+  // Each reduced variable y(j) is the value of a free variable x(reducedIndices(j)), so fixing that variable amounts to fixing y(j).
+  // The constraints are assumed to be local (as in the seamless integration constraints), and the elimination is sparse.
+  // Inputs:
+  //  C:          #C by #x sparse constraint matrix.
+  //  keepMask:   #x 1 for variables that should stay free (e.g., variables to be fixed or rounded), and 0 otherwise. Such a variable is only
+  //              eliminated by a row in which no other free variable has a coefficient above the tolerance.
+  //  tolerance:  relative magnitude under which a substituted row is considered to vanish.
+  // Outputs:
+  //  U:                #x by #y reduced basis.
+  //  reducedIndices:   #y variable represented by each reduced variable.
+  //  independentRows:  indices of a maximal linearly independent subset of the rows of C.
+  IGL_INLINE void eliminate_constraints(const Eigen::SparseMatrix<double>& C,
+                                        const Eigen::VectorXi& keepMask,
+                                        Eigen::SparseMatrix<double>& U,
+                                        Eigen::VectorXi& reducedIndices,
+                                        Eigen::VectorXi& independentRows,
+                                        const double tolerance=1e-10)
+  {
+    using namespace Eigen;
+    using namespace std;
+    typedef vector<pair<int,double> > Expression;
+
+    int numVars=C.cols();
+    SparseMatrix<double, RowMajor> CRows=C;
+    vector<Expression> pivotExpressions(numVars);
+    vector<int> pivotOrder;
+    vector<bool> isPivot(numVars, false);
+    vector<int> independentRowsList;
+
+    //sparse accumulator of the current row
+    vector<double> work(numVars, 0.0);
+    vector<bool> touched(numVars, false);
+    vector<int> touchedList, pivotStack;
+
+    for (int r=0;r<CRows.rows();r++){
+      double rowScale=0.0;
+      for (SparseMatrix<double, RowMajor>::InnerIterator it(CRows,r); it; ++it){
+        work[it.col()]+=it.value();
+        rowScale=std::max(rowScale, std::abs(it.value()));
+        if (!touched[it.col()]){
+          touched[it.col()]=true;
+          touchedList.push_back(it.col());
+          if (isPivot[it.col()])
+            pivotStack.push_back(it.col());
+        }
+      }
+
+      //substituting eliminated variables until the row is in free variables only
+      while (!pivotStack.empty()){
+        int p=pivotStack.back();
+        pivotStack.pop_back();
+        double coeff=work[p];
+        work[p]=0.0;
+        if (coeff==0.0)
+          continue;
+        for (size_t i=0;i<pivotExpressions[p].size();i++){
+          int j=pivotExpressions[p][i].first;
+          work[j]+=coeff*pivotExpressions[p][i].second;
+          if (!touched[j]){
+            touched[j]=true;
+            touchedList.push_back(j);
+          }
+          if (isPivot[j])
+            pivotStack.push_back(j);
+        }
+      }
+
+      //choosing the pivot: the largest coefficient among the variables that are not in keepMask, or among all if there are none
+      double maxCoeff=0.0, maxNonKeepCoeff=0.0;
+      int maxIndex=-1, maxNonKeepIndex=-1;
+      for (size_t i=0;i<touchedList.size();i++){
+        int j=touchedList[i];
+        if (isPivot[j])
+          continue;
+        double absCoeff=std::abs(work[j]);
+        if (absCoeff>maxCoeff){
+          maxCoeff=absCoeff;
+          maxIndex=j;
+        }
+        if ((!keepMask(j))&&(absCoeff>maxNonKeepCoeff)){
+          maxNonKeepCoeff=absCoeff;
+          maxNonKeepIndex=j;
+        }
+      }
+
+      if (maxCoeff>tolerance*rowScale){
+        int p=(maxNonKeepCoeff>tolerance*rowScale ? maxNonKeepIndex : maxIndex);
+        for (size_t i=0;i<touchedList.size();i++){
+          int j=touchedList[i];
+          if ((j!=p)&&(!isPivot[j])&&(std::abs(work[j])>tolerance*maxCoeff))
+            pivotExpressions[p].push_back(pair<int,double>(j, -work[j]/work[p]));
+        }
+        isPivot[p]=true;
+        pivotOrder.push_back(p);
+        independentRowsList.push_back(r);
+      }
+
+      for (size_t i=0;i<touchedList.size();i++){
+        work[touchedList[i]]=0.0;
+        touched[touchedList[i]]=false;
+      }
+      touchedList.clear();
+    }
+
+    //resolving the pivots in reverse order, so that every expression refers to free variables only
+    for (int k=(int)pivotOrder.size()-1;k>=0;k--){
+      int p=pivotOrder[k];
+      for (size_t i=0;i<pivotExpressions[p].size();i++){
+        int j=pivotExpressions[p][i].first;
+        if (isPivot[j]){
+          for (size_t l=0;l<pivotExpressions[j].size();l++){
+            int m=pivotExpressions[j][l].first;
+            work[m]+=pivotExpressions[p][i].second*pivotExpressions[j][l].second;
+            if (!touched[m]){
+              touched[m]=true;
+              touchedList.push_back(m);
+            }
+          }
+        } else {
+          work[j]+=pivotExpressions[p][i].second;
+          if (!touched[j]){
+            touched[j]=true;
+            touchedList.push_back(j);
+          }
+        }
+      }
+      pivotExpressions[p].clear();
+      for (size_t i=0;i<touchedList.size();i++){
+        int j=touchedList[i];
+        if (work[j]!=0.0)
+          pivotExpressions[p].push_back(pair<int,double>(j, work[j]));
+        work[j]=0.0;
+        touched[j]=false;
+      }
+      touchedList.clear();
+    }
+
+    VectorXi reducedColumn=VectorXi::Constant(numVars,-1);
+    vector<int> reducedIndicesList;
+    for (int i=0;i<numVars;i++)
+      if (!isPivot[i]){
+        reducedColumn(i)=reducedIndicesList.size();
+        reducedIndicesList.push_back(i);
+      }
+
+    vector<Triplet<double> > UTriplets;
+    for (int i=0;i<numVars;i++){
+      if (!isPivot[i])
+        UTriplets.push_back(Triplet<double>(i, reducedColumn(i), 1.0));
+      else
+        for (size_t l=0;l<pivotExpressions[i].size();l++)
+          UTriplets.push_back(Triplet<double>(i, reducedColumn(pivotExpressions[i][l].first), pivotExpressions[i][l].second));
+    }
+    U.resize(numVars, reducedIndicesList.size());
+    U.setFromTriplets(UTriplets.begin(), UTriplets.end());
+
+    reducedIndices=Map<VectorXi>(reducedIndicesList.data(), reducedIndicesList.size());
+    independentRows=Map<VectorXi>(independentRowsList.data(), independentRowsList.size());
+  }
+}
+
+#endif
@@ -15,7 +15,9 @@
 #include <directional/representative_to_raw.h>
 #include <directional/point_spheres.h>
 #include <directional/line_boxes.h>
+#include <directional/sample_faces.h>
 #include <Eigen/Core>
+#include <limits>
 
 
 namespace directional
@@ -100,6 +102,97 @@ namespace directional
     glyph_lines_raw(V, F, rawField, glyphColors, l/30, l/6, l/50, fieldV, fieldF, fieldC);
   }
   
+  // Level-of-detail version: draws glyphs only on the given sample faces (e.g., from sample_faces()), so that the size of the glyph mesh
+  // scales with the sampling density rather than with #F.
+  // Inputs:
+  //  V, F, rawField, glyphColor, width, length, height: as above.
+  //  samples:    #S faces on which glyphs are drawn.
+  //  clusters:   #F index into samples of the cluster of each face. Only used when aggregate is true.
+  //  aggregate:  if true, each glyph depicts the average of the directionals on its cluster instead of the directional on the sample face.
+  //              The vectors of each face are matched to those of the sample by the cyclic shift that aligns them best, and the average is projected to the plane of the sample.
+  // Outputs:
+  //  fieldV, fieldF, fieldC: as above.
+  void IGL_INLINE glyph_lines_raw_lod(const Eigen::MatrixXd &V,
+                                      const Eigen::MatrixXi &F,
+                                      const Eigen::VectorXi &samples,
+                                      const Eigen::VectorXi &clusters,
+                                      const Eigen::MatrixXd &rawField,
+                                      const Eigen::MatrixXd &glyphColor,
+                                      const bool aggregate,
+                                      double width,
+                                      double length,
+                                      double height,
+                                      Eigen::MatrixXd &fieldV,
+                                      Eigen::MatrixXi &fieldF,
+                                      Eigen::MatrixXd &fieldC)
+  {
+    int N=rawField.cols()/3;
+    Eigen::MatrixXi sampleF(samples.size(), F.cols());
+    Eigen::MatrixXd sampleField(samples.size(), rawField.cols());
+    for (int i=0;i<samples.size();i++){
+      sampleF.row(i)=F.row(samples(i));
+      sampleField.row(i)=rawField.row(samples(i));
+    }
+    
+    if (aggregate){
+      Eigen::MatrixXd normals;
+      igl::per_face_normals(V, sampleF, normals);
+      Eigen::MatrixXd sumField=Eigen::MatrixXd::Zero(samples.size(), rawField.cols());
+      Eigen::VectorXi clusterSizes=Eigen::VectorXi::Zero(samples.size());
+      for (int i=0;i<F.rows();i++){
+        int c=clusters(i);
+        int bestShift=0;
+        double bestAlignment=-std::numeric_limits<double>::max();
+        for (int k=0;k<N;k++){
+          double alignment=0.0;
+          for (int j=0;j<N;j++)
+            alignment+=sampleField.block<1,3>(c,3*j).dot(rawField.block<1,3>(i,3*((j+k)%N)));
+          if (alignment>bestAlignment){
+            bestAlignment=alignment;
+            bestShift=k;
+          }
+        }
+        for (int j=0;j<N;j++)
+          sumField.block<1,3>(c,3*j)+=rawField.block<1,3>(i,3*((j+bestShift)%N));
+        clusterSizes(c)++;
+      }
+      for (int i=0;i<samples.size();i++)
+        for (int j=0;j<N;j++){
+          Eigen::RowVector3d avgVector=sumField.block<1,3>(i,3*j)/(double)clusterSizes(i);
+          sampleField.block<1,3>(i,3*j)=avgVector-avgVector.dot(normals.row(i))*normals.row(i);
+        }
+    }
+    
+    Eigen::MatrixXd sampleColor=glyphColor;
+    if (glyphColor.rows()==F.rows()){
+      sampleColor.resize(samples.size(), glyphColor.cols());
+      for (int i=0;i<samples.size();i++)
+        sampleColor.row(i)=glyphColor.row(samples(i));
+    }
+    
+    glyph_lines_raw(V, sampleF, sampleField, sampleColor, width, length, height, fieldV, fieldF, fieldC);
+  }
+  
+  // Level-of-detail version that samples the faces at the given ring distance, without specification of glyph dimensions.
+  // The glyphs are lengthened with the distance between samples, so that the density of the depiction is kept.
+  void IGL_INLINE glyph_lines_raw_lod(const Eigen::MatrixXd &V,
+                                      const Eigen::MatrixXi &F,
+                                      const Eigen::MatrixXi &EF,
+                                      const Eigen::MatrixXd &rawField,
+                                      const Eigen::MatrixXd &glyphColors,
+                                      const int ringDistance,
+                                      const bool aggregate,
+                                      Eigen::MatrixXd &fieldV,
+                                      Eigen::MatrixXi &fieldF,
+                                      Eigen::MatrixXd &fieldC,
+                                      const double sizeRatio = 1.25)
+  {
+    Eigen::VectorXi samples, clusters;
+    sample_faces(F, EF, ringDistance, samples, clusters);
+    double l = sizeRatio*igl::avg_edge_length(V, F);
+    glyph_lines_raw_lod(V, F, samples, clusters, rawField, glyphColors, aggregate, l/30, (ringDistance+1)*l/6, l/50, fieldV, fieldF, fieldC);
+  }
+  
 }
 
 #endif
@@ -69,7 +69,7 @@ namespace directional
     linfError = (basisCycles*innerRotationAngles - (-cycleCurvature + cycleNewCurvature)).lpNorm<Infinity>();
   }
   
-  //Minimal version: no provided solver
+  //Minimal version: no provided solver. For many sets of indices on the same mesh, IndexPrescriptionSolver reuses the factorization.
   IGL_INLINE void index_prescription(const Eigen::MatrixXd& V,
                                      const Eigen::MatrixXi& F,
                                      const Eigen::VectorXi& innerEdges,
@@ -82,8 +82,6 @@ namespace directional
   {
     Eigen::MatrixXi EV, x, EF;
     igl::edge_topology(V, F, EV, x, EF);
-    Eigen::MatrixXd B1, B2, B3;
-    igl::local_basis(V, F, B1, B2, B3);
     Eigen::SimplicialLDLT<Eigen::SparseMatrix<double> > ldltSolver;
     index_prescription(V, F,EV, innerEdges, basisCycles,cycleCurvature, cycleIndices, ldltSolver, N, rotationAngles, error);
   }
@@ -14,6 +14,8 @@
 #include <vector>
 #include <cmath>
 #include <Eigen/Core>
+#include <Eigen/Sparse>
+#include <Eigen/SparseCholesky>
 #include <igl/igl_inline.h>
 #include <igl/gaussian_curvature.h>
 #include <igl/local_basis.h>
@@ -21,12 +23,15 @@
 #include <igl/edge_topology.h>
 #include <igl/min_quad_with_fixed.h>
 #include <igl/bounding_box_diagonal.h>
+#include <igl/Timer.h>
 #include <directional/tree.h>
 #include <directional/representative_to_raw.h>
 #include <directional/principal_matching.h>
 #include <directional/setup_integration.h>
 #include <directional/branched_gradient.h>
 #include <directional/iterative_rounding.h>
+#include <directional/eliminate_constraints.h>
+#include <directional/sparse_slice_rows.h>
 #include <igl/per_face_normals.h>
 
 namespace directional
@@ -99,7 +104,7 @@ namespace directional
     SparseMatrix<double> Mx(3*intData.N*cutF.rows(), 3*intData.N*cutF.rows());
     Mx.setFromTriplets(MxTri.begin(), MxTri.end());
     
-    //The variables that should be fixed in the end
+    //the variables that are fixed to begin with; the integer variables are rounded afterwards by iterative_rounding()
     VectorXi fixedMask(numVars);
     fixedMask.setZero();
     
@@ -107,19 +112,6 @@ namespace directional
     for (int i=0;i<intData.fixedIndices.size();i++)
       fixedMask(intData.fixedIndices(i)) = 1;
     
-    /*if(false)
-      for(int i = 0; i < intData.integerVars.size(); i++)
-        for (int j=0;j<intData.n;j++)
-          fixedMask(intData.n * intData.integerVars(i)+j) = 1;*/
-    
-    //the variables that were already fixed to begin with
-    VectorXi alreadyFixed(numVars);
-    alreadyFixed.setZero();
-    
-    
-    for (int i=0;i<intData.fixedIndices.size();i++)
-      alreadyFixed(intData.fixedIndices(i)) = 1;
-    
     //the values for the fixed variables (size is as all variables)
     VectorXd fixedValues(numVars);
     fixedValues.setZero();  //for everything but the originally fixed values
@@ -127,160 +119,92 @@ namespace directional
       fixedValues(intData.fixedIndices(i))=intData.fixedValues(i);
     
     SparseMatrix<double> Efull = d0 * intData.vertexTrans2CutMat * intData.linRedMat * intData.singIntSpanMat * intData.intSpanMat;
-    VectorXd x, xprev;
     
     // until then all the N depedencies should be resolved?
     
-    //reducing constraintMat
-    SparseQR<SparseMatrix<double>, COLAMDOrdering<int> > qrsolver;
+    //eliminating the linear constraints into a reduced basis fullx=U*y, where the fixed variables stay in the basis when possible
+    igl::Timer timer;
+    timer.start();
     SparseMatrix<double> Cfull = intData.constraintMat * intData.linRedMat * intData.singIntSpanMat * intData.intSpanMat;
-    if (Cfull.rows()!=0){
-      qrsolver.compute(Cfull.transpose());
-      int CRank = qrsolver.rank();
-      
-      //creating sliced permutation matrix
-      VectorXi PIndices = qrsolver.colsPermutation().indices();
-      
-      vector<Triplet<double> > CTriplets;
-      for(int k = 0; k < Cfull.outerSize(); ++k)
-      {
-        for(SparseMatrix<double>::InnerIterator it(Cfull, k); it; ++it)
-        {
-          for(int j = 0; j < CRank; j++)
-            if(it.row() == PIndices(j))
-              CTriplets.emplace_back(j, it.col(), it.value());
-        }
-      }
-      
-      Cfull.resize(CRank, Cfull.cols());
-      Cfull.setFromTriplets(CTriplets.begin(), CTriplets.end());
+    SparseMatrix<double> U;
+    VectorXi reducedIndices, independentRows;
+    eliminate_constraints(Cfull, fixedMask, U, reducedIndices, independentRows);
+    
+    //a fixed variable is only eliminated by a constraint among fixed variables alone, and is then checked after the solve
+    int numReduced = U.cols();
+    VectorXi reducedFixedMask(numReduced);
+    VectorXd reducedFixedValues(numReduced);
+    for (int j = 0; j < numReduced; j++){
+      reducedFixedMask(j) = fixedMask(reducedIndices(j));
+      reducedFixedValues(j) = fixedValues(reducedIndices(j));
     }
-    SparseMatrix<double> var2AllMat;
-    VectorXd fullx(numVars); fullx.setZero();
-    for(int intIter = 0; intIter < fixedMask.sum(); intIter++)
-    {
-      //the non-fixed variables to all variables
-      var2AllMat.resize(numVars, numVars - alreadyFixed.sum());
-      int varCounter = 0;
-      vector<Triplet<double> > var2AllTriplets;
-      for(int i = 0; i < numVars; i++)
-      {
-        if (!alreadyFixed(i)){
-          //for (int j=0;j<intData.d;j++)
-          var2AllTriplets.emplace_back(i, varCounter++, 1.0);
-        }
-        
-      }
-      var2AllMat.setFromTriplets(var2AllTriplets.begin(), var2AllTriplets.end());
-      
-      SparseMatrix<double> Epart = Efull * var2AllMat;
-      VectorXd torhs = -Efull * fixedValues;
-      SparseMatrix<double> EtE = Epart.transpose() * M1 * Epart;
-      SparseMatrix<double> Cpart = Cfull * var2AllMat;
-      
-      //reducing rank on Cpart
-      int CpartRank=0;
-      VectorXi PIndices(0);
-      if (Cpart.rows()!=0){
-        qrsolver.compute(Cpart.transpose());
-        CpartRank = qrsolver.rank();
-        
-        //creating sliced permutation matrix
-        PIndices = qrsolver.colsPermutation().indices();
-        
-        vector<Triplet<double> > CPartTriplets;
-        
-        for(int k = 0; k < Cpart.outerSize(); ++k)
-        {
-          for (SparseMatrix<double>::InnerIterator it(Cpart, k); it; ++it)
-          {
-            for (int j = 0; j < CpartRank; j++)
-              if (it.row() == PIndices(j))
-                CPartTriplets.emplace_back(j, it.col(), it.value());
-          }
-        }
-        
-        Cpart.resize(CpartRank, Cpart.cols());
-        Cpart.setFromTriplets(CPartTriplets.begin(), CPartTriplets.end());
-      }
-      SparseMatrix<double> A(EtE.rows()+ Cpart.rows(), EtE.rows() + Cpart.rows());
-      
-      vector<Triplet<double>> ATriplets;
-      for(int k = 0; k < EtE.outerSize(); ++k)
-      {
-        for (SparseMatrix<double>::InnerIterator it(EtE, k); it; ++it)
-          ATriplets.push_back(Triplet<double>(it.row(), it.col(), it.value()));
-      }
-      
-      for(int k = 0; k < Cpart.outerSize(); ++k)
-      {
-        for(SparseMatrix<double>::InnerIterator it(Cpart, k); it; ++it)
-        {
-          ATriplets.emplace_back(it.row() + EtE.rows(), it.col(), it.value());
-          ATriplets.emplace_back(it.col(), it.row() + EtE.rows(), it.value());
-        }
-      }
-      
-      A.setFromTriplets(ATriplets.begin(), ATriplets.end());
-      
-      //Right-hand side with fixed values
-      VectorXd b = VectorXd::Zero(EtE.rows() + Cpart.rows());
-      b.segment(0, EtE.rows())= Epart.transpose() * M1 * (gamma + torhs);
-      VectorXd bfull = -Cfull * fixedValues;
-      VectorXd bpart(CpartRank);
-      for(int k = 0; k < CpartRank; k++)
-        bpart(k)=bfull(PIndices(k));
-      b.segment(EtE.rows(), Cpart.rows()) = bpart;
-      
-      SparseLU<SparseMatrix<double> > lusolver;
-      lusolver.compute(A);
-      if(lusolver.info() != Success){
-        if (intData.verbose)
-          cout<<"LU decomposition failed!"<<endl;
-        return false;
-      }
-      x = lusolver.solve(b);
-      
-      fullx = var2AllMat * x.head(numVars - alreadyFixed.sum()) + fixedValues;
-      
-      
-      if((alreadyFixed - fixedMask).sum() == 0)
-        break;
-      
-      double minIntDiff = std::numeric_limits<double>::max();
-      int minIntDiffIndex = -1;
-      for (int i = 0; i < numVars; i++)
-      {
-        if ((fixedMask(i)) && (!alreadyFixed(i)))
-        {
-          double currIntDiff =0;
-          double func = fullx(i); //fullx.segment(intData.d*i,intData.d);
-          //for (int j=0;j<intData.d;j++)
-          currIntDiff += std::fabs(func - std::round(func));
-          if (currIntDiff < minIntDiff)
-          {
-            minIntDiff = currIntDiff;
-            minIntDiffIndex = i;
-          }
-        }
-      }
-
-      if (minIntDiffIndex != -1)
-      {
-        alreadyFixed(minIntDiffIndex) = 1;
-        double func = fullx(minIntDiffIndex) ;
-        double funcInteger=std::round(func);
-        fixedValues(minIntDiffIndex) = /*pinvSymm*projMat**/funcInteger;
-      }
-      
-      xprev.resize(x.rows() - 1);
-      varCounter = 0;
-      for(int i = 0; i < numVars; i++)
-        if (!alreadyFixed(i))
-          xprev(varCounter++) = fullx(i);
-      
-      xprev.tail(Cpart.rows()) = x.tail(Cpart.rows());
+    
+    //the independent constraints, as required by iterative_rounding
+    SparseMatrix<double> CIndependent;
+    sparse_slice_rows(Cfull, independentRows, CIndependent);
+    Cfull = CIndependent;
+    if (intData.verbose)
+      cout<<"Eliminated "<<Cfull.rows()<<" constraints into "<<numReduced<<" reduced variables: "<<timer.getElapsedTimeInSec()<<"s"<<endl;
+    
+    //The reduced system, where the rows and columns of fixed variables are replaced by identity ones. A small regularization keeps it
+    //definite when the energy has a null space, and is removed by iterative refinement against the unregularized system.
+    timer.start();
+    SparseMatrix<double> EU = Efull * U;
+    SparseMatrix<double> EtE = EU.transpose() * M1 * EU;
+    VectorXd EtGamma = EU.transpose() * M1 * gamma;
+    double regularization = 1e-10 * (EtE.nonZeros()>0 ? EtE.diagonal().cwiseAbs().mean() : 1.0);
+    
+    vector<Triplet<double> > ATriplets, ARegTriplets;
+    for(int k = 0; k < EtE.outerSize(); ++k)
+      for (SparseMatrix<double>::InnerIterator it(EtE, k); it; ++it)
+        if ((!reducedFixedMask(it.row())) && (!reducedFixedMask(it.col())))
+          ATriplets.emplace_back(it.row(), it.col(), it.value());
+    
+    ARegTriplets = ATriplets;
+    for (int i = 0; i < numReduced; i++){
+      if (reducedFixedMask(i))
+        ATriplets.emplace_back(i, i, 1.0);
+      ARegTriplets.emplace_back(i, i, (reducedFixedMask(i) ? 1.0 : regularization));
+    }
+    
+    SparseMatrix<double> A(numReduced, numReduced), AReg(numReduced, numReduced);
+    A.setFromTriplets(ATriplets.begin(), ATriplets.end());
+    AReg.setFromTriplets(ARegTriplets.begin(), ARegTriplets.end());
+    
+    //Right-hand side with fixed values
+    VectorXd b = EtGamma - EtE * reducedFixedValues;
+    for (int i = 0; i < numReduced; i++)
+      if (reducedFixedMask(i))
+        b(i) = reducedFixedValues(i);
+    
+    SimplicialLDLT<SparseMatrix<double> > ldltSolver;
+    ldltSolver.compute(AReg);
+    if(ldltSolver.info() != Success){
+      if (intData.verbose)
+        cout<<"LDLT decomposition failed!"<<endl;
+      return false;
     }
+    VectorXd y = ldltSolver.solve(b);
+    for (int i = 0; i < 2; i++)
+      y += ldltSolver.solve(b - A * y);
+    
+    for (int i = 0; i < numReduced; i++)
+      if (reducedFixedMask(i))
+        y(i) = reducedFixedValues(i);
+    VectorXd fullx = U * y;
+    
+    //the prescribed values must satisfy the constraints among them
+    double maxFixedError = 0.0;
+    for (int i = 0; i < intData.fixedIndices.size(); i++)
+      maxFixedError = std::max(maxFixedError, std::fabs(fullx(intData.fixedIndices(i)) - intData.fixedValues(i)));
+    if (maxFixedError > 1e-7 * (1.0 + intData.fixedValues.cwiseAbs().maxCoeff())){
+      if (intData.verbose)
+        cout<<"The fixed values are inconsistent with the constraints (error "<<maxFixedError<<")!"<<endl;
+      return false;
+    }
+    
+    if (intData.verbose)
+      cout<<"Linear solve with "<<reducedFixedMask.sum()<<" fixed variables: "<<timer.getElapsedTimeInSec()<<"s"<<endl;
     
     //the results are packets of N functions for each vertex, and need to be allocated for corners
     VectorXd NFunctionVec = intData.vertexTrans2CutMat * intData.linRedMat * intData.singIntSpanMat * intData.intSpanMat * fullx;
@@ -310,7 +234,7 @@ namespace directional
         integerIndices(intData.n * i+j) = intData.n * intData.integerVars(i)+j;
     
     
-    bool success=directional::iterative_rounding(Efull, rawField, intData.fixedIndices, intData.fixedValues, intData.singularIndices, integerIndices, intData.lengthRatio, gamma, Cfull, Gd, FN, intData.N, intData.n, cutV, cutF, x2CornerMat,  intData.integralSeamless, intData.roundSeams, intData.localInjectivity, intData.verbose, fullx);
+    bool success=directional::iterative_rounding(Efull, rawField, intData.fixedIndices, intData.fixedValues, intData.singularIndices, integerIndices, intData.lengthRatio, gamma, Cfull, Gd, FN, intData.N, intData.n, cutV, cutF, x2CornerMat,  intData.integralSeamless, intData.roundSeams, intData.localInjectivity, intData.verbose, fullx, intData.blockRounding, intData.roundingTolerance);
     
     
     if ((!success)&&(intData.verbose))
@@ -17,6 +17,7 @@
 #include <iostream>
 #include <Eigen/Core>
 #include <iomanip>
+#include <igl/Timer.h>
 
 
 
@@ -51,7 +52,9 @@ bool iterative_rounding(const Eigen::SparseMatrix<double>& A,
                         const bool roundSeams,
                         const bool localInjectivity,
                         const bool verbose,
-                        Eigen::VectorXd& fullx){
+                        Eigen::VectorXd& fullx,
+                        const bool blockRounding=false,
+                        const double roundingTolerance=0.1){
   
   using namespace Eigen;
   using namespace std;
@@ -100,6 +103,8 @@ bool iterative_rounding(const Eigen::SparseMatrix<double>& A,
   }
   
   irTraits.init(slTraits, initialSolutionLMSolver.x, roundSeams);
+  irTraits.blockRounding=blockRounding;
+  irTraits.roundingTolerance=roundingTolerance;
   
   if (!fullySeamless){
     fullx=irTraits.x0;
@@ -116,19 +121,26 @@ bool iterative_rounding(const Eigen::SparseMatrix<double>& A,
     cout << std::right << setw(colWidth) << setfill(' ') << "Energy";
     cout << std::right << setw(colWidth) << setfill(' ') << "1st-ord. Optimality";
     cout << std::right << setw(colWidth) << setfill(' ') << "# Iterations";
+    cout << std::right << setw(colWidth) << setfill(' ') << "# Rounded";
     cout<<endl;
   }
   
+  //the linear solver is shared by all the LM solves, which start from the previous solution
   bool success=true;
   bool hasRounded=false;
-  while (irTraits.leftIndices.size()!=0){
-    //cout<<"i: "<<i++<<endl;
+  int numSolves=0;
+  double solveTime=0.0, checkTime=0.0;
+  igl::Timer timer;
+  while (!irTraits.leftHeap.empty()){
     if (!irTraits.initFixedIndices())
       continue;
     hasRounded=true;
+    timer.start();
     dIRTraits.currLambda=(localInjectivity ? 0.01 : 0.0);
     iterativeRoundingLMSolver.init(&lSolver2, &irTraits, &dIRTraits, 100, 1e-7, 1e-7);
     iterativeRoundingLMSolver.solve(false);
+    solveTime+=timer.getElapsedTimeInSec();
+    numSolves++;
     if (verbose){
       printElement(irTraits.currRoundIndex, colWidth);
       printElement(irTraits.origValue, colWidth);
@@ -136,9 +148,13 @@ bool iterative_rounding(const Eigen::SparseMatrix<double>& A,
       printElement(iterativeRoundingLMSolver.energy, colWidth);
       printElement(iterativeRoundingLMSolver.fooOptimality, colWidth);
       printElement(iterativeRoundingLMSolver.currIter, colWidth);
+      printElement(irTraits.numRounded, colWidth);
       cout<<endl;
     }
-    if (!irTraits.post_checking(iterativeRoundingLMSolver.x)){
+    timer.start();
+    bool checked=irTraits.post_checking(iterativeRoundingLMSolver.x);
+    checkTime+=timer.getElapsedTimeInSec();
+    if (!checked){
       success=false;
       if (verbose)
         cout<<"Failed to round!"<<endl;
@@ -146,8 +162,10 @@ bool iterative_rounding(const Eigen::SparseMatrix<double>& A,
     }
   }
   
-  if (verbose)
+  if (verbose){
     cout<<"Iterative rounding "<<(success ? "succeeded!" : "failed!")<<endl;
+    cout<<"Rounding with "<<numSolves<<" LM solves: selection "<<irTraits.selectionTime<<"s ("<<irTraits.numSelections<<" selections, "<<irTraits.numKeyUpdates<<" key updates), jacobian update "<<irTraits.jacobianTime<<"s, LM solves "<<solveTime<<"s, checking "<<checkTime<<"s"<<endl;
+  }
   
   if (hasRounded)
     fullx=irTraits.UFull*iterativeRoundingLMSolver.x;
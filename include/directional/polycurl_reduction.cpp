@@ -8,6 +8,7 @@
 
 
 #include <iostream>
+#include <limits>
 #include <igl/parallel_transport_angles.h>
 #include <igl/local_basis.h>
 #include <igl/edge_topology.h>
@@ -16,6 +17,8 @@
 #include <igl/slice.h>
 #include <igl/slice_into.h>
 #include <igl/sort_vectors_ccw.h>
+#include <igl/parallel_for.h>
+#include <igl/Timer.h>
 #include <directional/polycurl_reduction.h>
 #include <directional/field_local_global_conversions.h>
 
@@ -31,7 +34,12 @@ wCloseUnconstrained(1e-3),
 wCloseConstrained(100),
 redFactor_wsmooth(.8),
 gamma(0.1),
-tikh_gamma(1e-8)
+tikh_gamma(1e-8),
+inexactNewton(false),
+forcingTerm(0.1),
+forcingTermFactor(0.5),
+minForcingTerm(1e-6),
+maxCGIterations(1000)
 {}
 
 
@@ -87,6 +95,14 @@ namespace directional
                                      const Eigen::VectorXd &x_initial,
                                      Eigen::VectorXd &x);
 
+    //Solves J^T*J*direction = rhs with Jacobi-preconditioned CG up to the given relative residual, without forming J^T*J.
+    //Returns the number of iterations.
+    IGL_INLINE int solveNormalEquationsCG(const Eigen::VectorXd &rhs,
+                                          const double tolerance,
+                                          const int maxIterations,
+                                          Eigen::VectorXd &direction,
+                                          double &relativeResidual);
+
     //Compute residuals and Jacobian for Gauss Newton
     IGL_INLINE double RJ(const Eigen::VectorXd &x,
                          const Eigen::VectorXd &x0,
@@ -445,6 +461,12 @@ IGL_INLINE void directional::PolyCurlReductionSolverData::computeJacobianPattern
                        II_Jac,
                        JJ_Jac);
   igl::sparse(II_Jac, JJ_Jac, SS_Jac, Jac);
+  Jac.makeCompressed();
+
+  //the pattern is fixed, so the values are later written directly
+  indInJacValues.resize(numJacElements);
+  for (int i=0; i<numJacElements; ++i)
+    indInJacValues[i] = &Jac.coeffRef(II_Jac(i), JJ_Jac(i)) - Jac.valuePtr();
 }
 
 
@@ -479,19 +501,36 @@ IGL_INLINE void directional::PolyCurlReductionSolverData::computeHessianPattern(
   Hess.resize(Jac.cols(),Jac.cols());
   Hess.setFromTriplets(Hess_triplets.begin(), Hess_triplets.end());
   Hess.makeCompressed();
+
+  //group the products by the nonzero of Hess they sum into
+  std::vector<int> indInHessValues(Hess_triplets.size());
+  HessPairsStart.assign(Hess.nonZeros()+1, 0);
+  for (int i =0; i<Hess_triplets.size(); ++i)
+  {
+    indInHessValues[i] = &Hess.coeffRef(Hess_triplets[i].row(), Hess_triplets[i].col()) - Hess.valuePtr();
+    HessPairsStart[indInHessValues[i]+1]++;
+  }
+  for (int k =0; k<Hess.nonZeros(); ++k)
+    HessPairsStart[k+1] += HessPairsStart[k];
+  HessPairs.resize(Hess_triplets.size());
+  std::vector<int> nextPair(HessPairsStart.begin(), HessPairsStart.end()-1);
+  for (int i =0; i<Hess_triplets.size(); ++i)
+    HessPairs[nextPair[indInHessValues[i]]++] = i;
 }
 
 
 
 IGL_INLINE void directional::PolyCurlReductionSolverData::computeNewHessValues()
 {
-  for (int i =0; i<Hess_triplets.size(); ++i)
-    Hess_triplets[i] = Eigen::Triplet<double>(Hess_triplets[i].row(),
-                                              Hess_triplets[i].col(),
-                                              SS_Jac(indInSS_Hess_1_vec[i])*SS_Jac(indInSS_Hess_2_vec[i])
-                                              );
-
-  Hess.setFromTriplets(Hess_triplets.begin(), Hess_triplets.end());
+  //J^T*J into the fixed pattern of Hess, every nonzero summed independently
+  double *HessValues = Hess.valuePtr();
+  igl::parallel_for(Hess.nonZeros(), [&](const int k)
+  {
+    double value = 0;
+    for (int p = HessPairsStart[k]; p<HessPairsStart[k+1]; ++p)
+      value += SS_Jac(indInSS_Hess_1_vec[HessPairs[p]])*SS_Jac(indInSS_Hess_2_vec[HessPairs[p]]);
+    HessValues[k] = value;
+  }, 1000);
 }
 
 
@@ -536,6 +575,8 @@ IGL_INLINE void directional::PolyCurlReductionSolver::solveGaussNewton(polycurl_
   Eigen::VectorXd xprev = x;
   Eigen::VectorXd xc = igl::slice(x_initial, data.constrained, 1);
   //  double ESmooth, EClose, ECurl, EQuotCurl, EBarrier;
+  igl::Timer timer;
+  double RJTime, factorizationTime, solveTime, lineSearchTime;
   for (int innerIter = 0; innerIter<params.numIter; ++innerIter)
   {
 
@@ -544,7 +585,9 @@ IGL_INLINE void directional::PolyCurlReductionSolver::solveGaussNewton(polycurl_
 
 
     //get function, gradients and Hessians
+    timer.start();
     F = RJ(x, xprev, params, true);
+    RJTime = timer.getElapsedTimeInSec();
 
     printf("PolyCurlReductionSolver -- Iteration %d\n", innerIter);
 
@@ -563,21 +606,38 @@ IGL_INLINE void directional::PolyCurlReductionSolver::solveGaussNewton(polycurl_
 
     Eigen::VectorXd rhs = data.Jac.transpose()*data.residuals;
 
-    bool success;
-    data.solver.factorize(data.Hess);
-    success = data.solver.info() == Eigen::Success;
-
-    if(!success)
-      std::cerr<<"PolyCurlReductionSolver -- Could not do LU"<<std::endl;
-
     Eigen::VectorXd direction;
-
-    double error;
-    direction = data.solver.solve(rhs);
-    error = (data.Hess*direction - rhs).cwiseAbs().maxCoeff();
-    if(error> 1e-4)
+    if (!params.inexactNewton)
     {
-      std::cerr<<"PolyCurlReductionSolver -- Could not solve"<<std::endl;
+      bool success;
+      timer.start();
+      data.solver.factorize(data.Hess);
+      factorizationTime = timer.getElapsedTimeInSec();
+      success = data.solver.info() == Eigen::Success;
+
+      if(!success)
+        std::cerr<<"PolyCurlReductionSolver -- Could not do LU"<<std::endl;
+
+      double error;
+      timer.start();
+      direction = data.solver.solve(rhs);
+      solveTime = timer.getElapsedTimeInSec();
+      error = (data.Hess*direction - rhs).cwiseAbs().maxCoeff();
+      if(error> 1e-4)
+      {
+        std::cerr<<"PolyCurlReductionSolver -- Could not solve"<<std::endl;
+      }
+    }
+    else
+    {
+      //the step only needs to be as accurate as the forcing term of this iteration
+      double forcingTerm = std::max(params.minForcingTerm, params.forcingTerm*pow(params.forcingTermFactor, innerIter));
+      double relativeResidual;
+      factorizationTime = 0;
+      timer.start();
+      int numCGIterations = solveNormalEquationsCG(rhs, forcingTerm, params.maxCGIterations, direction, relativeResidual);
+      solveTime = timer.getElapsedTimeInSec();
+      printf("PolyCurlReductionSolver -- PCG: %d iterations, relative residual %.3g (forcing term %.3g)\n", numCGIterations, relativeResidual, forcingTerm);
     }
 
     // adaptive backtracking
@@ -586,6 +646,7 @@ IGL_INLINE void directional::PolyCurlReductionSolver::solveGaussNewton(polycurl_
     Eigen::VectorXd cx;
     Eigen::VectorXd tRes;
     double newF;
+    timer.start();
     while(repeat)
     {
       cx = x - params.gamma*direction;
@@ -607,6 +668,8 @@ IGL_INLINE void directional::PolyCurlReductionSolver::solveGaussNewton(polycurl_
       }
       run++;
     }
+    lineSearchTime = timer.getElapsedTimeInSec();
+    printf("PolyCurlReductionSolver -- residuals and derivatives: %.3gs, factorization: %.3gs, solve: %.3gs, line search (%d evaluations): %.3gs\n", RJTime, factorizationTime, solveTime, run, lineSearchTime);
 
 
     if (!converged)
@@ -625,6 +688,56 @@ IGL_INLINE void directional::PolyCurlReductionSolver::solveGaussNewton(polycurl_
 }
 
 
+IGL_INLINE int directional::PolyCurlReductionSolver::solveNormalEquationsCG(const Eigen::VectorXd &rhs,
+                                                                            const double tolerance,
+                                                                            const int maxIterations,
+                                                                            Eigen::VectorXd &direction,
+                                                                            double &relativeResidual)
+{
+  //the diagonal of J^T*J are the squared column norms of J
+  Eigen::VectorXd invDiagonal(data.Jac.cols());
+  igl::parallel_for(data.Jac.cols(), [&](const int j)
+  {
+    double diagonal = data.Jac.col(j).squaredNorm();
+    invDiagonal(j) = (diagonal > 0 ? 1.0/diagonal : 1.0);
+  }, 10000);
+
+  direction.setZero(rhs.size());
+  double rhsNorm = rhs.norm();
+  relativeResidual = 0.0;
+  if (rhsNorm == 0)
+    return 0;
+
+  Eigen::VectorXd r = rhs;
+  Eigen::VectorXd z = invDiagonal.cwiseProduct(r);
+  Eigen::VectorXd p = z;
+  Eigen::VectorXd Jp, JTJp;
+  double rz = r.dot(z);
+  int iteration = 0;
+  relativeResidual = 1.0;
+  while ((relativeResidual > tolerance) && (iteration < maxIterations))
+  {
+    Jp = data.Jac*p;
+    //p is in the null space of J (to machine precision), so the step along it is unbounded
+    double curvature = Jp.squaredNorm();
+    if (curvature <= std::numeric_limits<double>::epsilon()*rz)
+      break;
+    JTJp = data.Jac.transpose()*Jp;
+    double alpha = rz/curvature;
+    direction += alpha*p;
+    r -= alpha*JTJp;
+    iteration++;
+    relativeResidual = r.norm()/rhsNorm;
+
+    z = invDiagonal.cwiseProduct(r);
+    double rzNew = r.dot(z);
+    p = z + (rzNew/rz)*p;
+    rz = rzNew;
+  }
+  return iteration;
+}
+
+
 IGL_INLINE double directional::PolyCurlReductionSolver::RJ(const Eigen::VectorXd &x,
                                                            const Eigen::VectorXd &x0,
                                                            const polycurl_reduction_parameters &params,
@@ -667,9 +780,13 @@ IGL_INLINE double directional::PolyCurlReductionSolver::RJ(const Eigen::VectorXd
 
   if(doJacs)
   {
-    for (int i =0; i<data.numJacElements; ++i)
-      data.Jac.coeffRef(data.II_Jac(i), data.JJ_Jac(i)) = data.SS_Jac(i);
-    data.computeNewHessValues();
+    double *JacValues = data.Jac.valuePtr();
+    igl::parallel_for(data.numJacElements, [&](const int i)
+    {
+      JacValues[data.indInJacValues[i]] = data.SS_Jac(i);
+    }, 10000);
+    if (!params.inexactNewton)
+      data.computeNewHessValues();
   }
 
   return data.residuals.transpose()*data.residuals;
@@ -761,7 +878,7 @@ IGL_INLINE void directional::PolyCurlReductionSolver::RJ_Smoothness(const Eigen:
 {
   if (wSmoothSqrt ==0)
     return;
-  for (int ii=0; ii<data.numInteriorEdges; ++ii)
+  igl::parallel_for(data.numInteriorEdges, [&](const int ii)
   {
     // the two faces of the flap
     int a = data.E2F_int(ii,0);
@@ -788,7 +905,7 @@ IGL_INLINE void directional::PolyCurlReductionSolver::RJ_Smoothness(const Eigen:
       int startIndex = startIndexInVectors+data.numInnerJacRows_smooth*data.numInnerJacCols_edge*ii;
       data.add_Jacobian_to_svector(startIndex, wSmoothSqrt*tJac,data.SS_Jac);
     }
-  }
+  }, 1000);
 }
 
 
@@ -852,7 +969,7 @@ IGL_INLINE void directional::PolyCurlReductionSolver::RJ_Barrier(const Eigen::Ma
   if (wBarrierSqrt ==0)
     return;
 
-  for (int fi=0; fi<data.numF; ++fi)
+  igl::parallel_for(data.numF, [&](const int fi)
   {
     Eigen::MatrixXd tJac;
     Eigen::VectorXd tRes;
@@ -870,7 +987,7 @@ IGL_INLINE void directional::PolyCurlReductionSolver::RJ_Barrier(const Eigen::Ma
       int startIndex = startIndexInVectors+data.numInnerJacRows_barrier*data.numInnerJacCols_face*fi;
       data.add_Jacobian_to_svector(startIndex, wBarrierSqrt*tJac,data.SS_Jac);
     }
-  }
+  }, 1000);
 }
 
 
@@ -884,7 +1001,7 @@ IGL_INLINE void directional::PolyCurlReductionSolver::RJ_Closeness(const Eigen::
 {
   if (wCloseUnconstrainedSqrt ==0 && wCloseConstrainedSqrt ==0)
     return;
-  for (int fi=0; fi<data.numF; ++fi)
+  igl::parallel_for(data.numF, [&](const int fi)
   {
     Eigen::Vector4d weights;
     if (!data.is_constrained_face[fi])
@@ -912,7 +1029,7 @@ IGL_INLINE void directional::PolyCurlReductionSolver::RJ_Closeness(const Eigen::
       data.add_Jacobian_to_svector(startIndex, weights.asDiagonal()*tJac,data.SS_Jac);
     }
 
-  }
+  }, 1000);
 }
 
 
@@ -969,7 +1086,7 @@ IGL_INLINE void directional::PolyCurlReductionSolver::RJ_Curl(const Eigen::Matri
 {
   if((wCASqrt==0) &&(wCBSqrt==0))
     return;
-  for (int ii=0; ii<data.numInteriorEdges; ++ii)
+  igl::parallel_for(data.numInteriorEdges, [&](const int ii)
   {
     // the two faces of the flap
     int a = data.E2F_int(ii,0);
@@ -1015,7 +1132,7 @@ IGL_INLINE void directional::PolyCurlReductionSolver::RJ_Curl(const Eigen::Matri
       data.add_Jacobian_to_svector(startIndex, tJac,data.SS_Jac);
     }
 
-  }
+  }, 1000);
 }
 
 
@@ -1067,7 +1184,7 @@ IGL_INLINE void directional::PolyCurlReductionSolver::RJ_QuotCurl(const Eigen::M
                                                                   bool doJacs,
                                                                   const int startIndexInVectors)
 {
-  for (int ii=0; ii<data.numInteriorEdges; ++ii)
+  igl::parallel_for(data.numInteriorEdges, [&](const int ii)
   {
     // the two faces of the flap
     int a = data.E2F_int(ii,0);
@@ -1106,7 +1223,7 @@ IGL_INLINE void directional::PolyCurlReductionSolver::RJ_QuotCurl(const Eigen::M
       int startIndex = startIndexInVectors+data.numInnerJacRows_quotcurl*data.numInnerJacCols_edge*ii;
       data.add_Jacobian_to_svector(startIndex, wQuotCurlSqrt*tJac,data.SS_Jac);
     }
-  }
+  }, 1000);
 }
 
 
@@ -97,6 +97,16 @@ struct directional::polycurl_reduction_parameters
   double gamma;
   //tikhonov regularization term (typically not needed, default value should suffice)
   double tikh_gamma;
+  //inexact Newton mode: solve the Gauss-Newton normal equations with Jacobi-preconditioned CG and matrix-free J^T*J products
+  //instead of factorizing J^T*J, which pays off on large meshes
+  bool inexactNewton;
+  //forcing term of the inexact solve (relative residual of CG) at the first iteration, its per-iteration reduction factor,
+  //and its lower bound: eta_k = max(minForcingTerm, forcingTerm*forcingTermFactor^k)
+  double forcingTerm;
+  double forcingTermFactor;
+  double minForcingTerm;
+  //maximum number of CG iterations per Gauss-Newton step
+  int maxCGIterations;
 
   IGL_INLINE polycurl_reduction_parameters();
 
@@ -192,6 +202,11 @@ public:
   std::vector<int> indInSS_Hess_2_vec;
   Eigen::SparseMatrix<double> Hess;
   std::vector<Eigen::Triplet<double> > Hess_triplets;
+  //position of every element of SS_Jac in Jac.valuePtr()
+  std::vector<int> indInJacValues;
+  //for every nonzero k of Hess, the products of Jacobian elements that sum into it are indInSS_Hess_1/2_vec[HessPairs[HessPairsStart[k]..HessPairsStart[k+1]-1]]
+  std::vector<int> HessPairsStart;
+  std::vector<int> HessPairs;
   Eigen::SimplicialLDLT<Eigen::SparseMatrix<double> > solver;
 
   IGL_INLINE void precomputeMesh(const Eigen::MatrixXd &_V,
@@ -0,0 +1,212 @@
+// This file is part of Directional, a library for directional field processing.
+// Copyright (C) 2018 Amir Vaxman <avaxman@gmail.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef DIRECTIONAL_POLYNOMIAL_ROOTS_H
+#define DIRECTIONAL_POLYNOMIAL_ROOTS_H
+
+#include <cmath>
+#include <complex>
+#include <Eigen/Core>
+#include <Eigen/Eigenvalues>
+#include <igl/igl_inline.h>
+#include <igl/parallel_for.h>
+
+namespace directional
+{
+  // Roots of a monic polynomial of compile-time degree N as the eigenvalues of its fixed-size companion matrix, which are backward stable.
+  template <int N, typename Scalar>
+  IGL_INLINE void companion_roots(const Eigen::Matrix<Scalar, N, 1>& coeffs,
+                                  Eigen::Matrix<std::complex<double>, N, 1>& roots)
+  {
+    Eigen::Matrix<Scalar, N, N> companion;
+    companion.setZero();
+    companion.template block<N-1, N-1>(1, 0).setIdentity();
+    companion.col(N-1) = -coeffs;
+    roots = companion.eigenvalues();
+  }
+
+  // Roots of monic polynomials z^N + c(N-1)*z^(N-1) + ... + c(0), as in the polyvector representation, with the degree known at compile time.
+  // Degrees 1, 2 and 4 are solved in closed form, and the other degrees with a fixed-size companion matrix, so that no call allocates.
+  // The quartic closed form is checked by the residual of its roots, and falls back to the companion matrix when it is inaccurate.
+  // The roots are not sorted.
+  template <int N, typename Scalar>
+  struct PolynomialRoots
+  {
+    static IGL_INLINE void compute(const Eigen::Matrix<Scalar, N, 1>& coeffs,
+                                   Eigen::Matrix<std::complex<double>, N, 1>& roots)
+    {
+      companion_roots<N, Scalar>(coeffs, roots);
+    }
+  };
+
+  template <typename Scalar>
+  struct PolynomialRoots<1, Scalar>
+  {
+    static IGL_INLINE void compute(const Eigen::Matrix<Scalar, 1, 1>& coeffs,
+                                   Eigen::Matrix<std::complex<double>, 1, 1>& roots)
+    {
+      roots(0) = -std::complex<double>(coeffs(0));
+    }
+  };
+
+  template <typename Scalar>
+  struct PolynomialRoots<2, Scalar>
+  {
+    static IGL_INLINE void compute(const Eigen::Matrix<Scalar, 2, 1>& coeffs,
+                                   Eigen::Matrix<std::complex<double>, 2, 1>& roots)
+    {
+      //the root of larger magnitude without cancellation, and the other from the product of the roots
+      std::complex<double> b = coeffs(1), c = coeffs(0);
+      std::complex<double> disc = std::sqrt(b*b - 4.0*c);
+      std::complex<double> q = -0.5*(std::abs(b+disc) > std::abs(b-disc) ? b+disc : b-disc);
+      if (std::abs(q) == 0.0){
+        roots.setZero();
+        return;
+      }
+      roots << q, c/q;
+    }
+  };
+
+  template <typename Scalar>
+  struct PolynomialRoots<4, Scalar>
+  {
+    static IGL_INLINE void compute(const Eigen::Matrix<Scalar, 4, 1>& coeffs,
+                                   Eigen::Matrix<std::complex<double>, 4, 1>& roots)
+    {
+      typedef std::complex<double> Complex;
+      Complex a = coeffs(3), b = coeffs(2), c = coeffs(1), d = coeffs(0);
+
+      //Ferrari: the depressed quartic y^4+py^2+qy+r with z=y-a/4
+      Complex p = b - 3.0*a*a/8.0;
+      Complex q = c - a*b/2.0 + a*a*a/8.0;
+      Complex r = d - a*c/4.0 + a*a*b/16.0 - 3.0*a*a*a*a/256.0;
+
+      //the root of largest magnitude of the resolvent cubic m^3+pm^2+(p^2/4-r)m-q^2/8, by Cardano
+      Complex P = (p*p/4.0 - r) - p*p/3.0;
+      Complex Q = 2.0*p*p*p/27.0 - p*(p*p/4.0 - r)/3.0 - q*q/8.0;
+      Complex sqrtDisc = std::sqrt(Q*Q/4.0 + P*P*P/27.0);
+      Complex u3 = (std::abs(-Q/2.0 + sqrtDisc) > std::abs(-Q/2.0 - sqrtDisc) ? -Q/2.0 + sqrtDisc : -Q/2.0 - sqrtDisc);
+      Complex m = 0.0;
+      if (std::abs(u3) > 0.0){
+        Complex u = std::pow(u3, 1.0/3.0);
+        const Complex omega(-0.5, std::sqrt(3.0)/2.0);
+        for (int k = 0; k < 3; k++, u *= omega){
+          Complex candidate = u - P/(3.0*u) - p/3.0;
+          if (std::abs(candidate) > std::abs(m))
+            m = candidate;
+        }
+      } else
+        m = -p/3.0;
+
+      Eigen::Matrix<Complex, 2, 1> quadCoeffs;
+      Eigen::Matrix<Complex, 2, 1> quadRoots;
+      if (std::abs(m) == 0.0){
+        //q=0: biquadratic y^4+py^2+r
+        quadCoeffs << r, p;
+        PolynomialRoots<2, Complex>::compute(quadCoeffs, quadRoots);
+        roots << std::sqrt(quadRoots(0)), -std::sqrt(quadRoots(0)), std::sqrt(quadRoots(1)), -std::sqrt(quadRoots(1));
+      } else {
+        //(y^2+p/2+m)^2 = (sy-q/(2s))^2 with s=sqrt(2m)
+        Complex s = std::sqrt(2.0*m);
+        quadCoeffs << p/2.0 + m + q/(2.0*s), -s;
+        PolynomialRoots<2, Complex>::compute(quadCoeffs, quadRoots);
+        roots.head<2>() = quadRoots;
+        quadCoeffs << p/2.0 + m - q/(2.0*s), s;
+        PolynomialRoots<2, Complex>::compute(quadCoeffs, quadRoots);
+        roots.tail<2>() = quadRoots;
+      }
+      roots.array() -= a/4.0;
+
+      //a Newton step on the original polynomial removes the cancellation error of the closed form
+      const double residualTolerance = 1e-10;
+      bool accurate = true;
+      for (int i = 0; i < 4; i++){
+        Complex z = roots(i);
+        Complex value = (((z + a)*z + b)*z + c)*z + d;
+        Complex derivative = ((4.0*z + 3.0*a)*z + 2.0*b)*z + c;
+        if (std::abs(derivative) > 1e-12*(1.0 + std::abs(value)))
+          roots(i) = z = z - value/derivative;
+
+        //relative residual |p(z)|/sum|c_k||z|^k, which is around machine precision for a backward-stable root
+        value = (((z + a)*z + b)*z + c)*z + d;
+        double absZ = std::abs(z);
+        double scale = (((absZ + std::abs(a))*absZ + std::abs(b))*absZ + std::abs(c))*absZ + std::abs(d);
+        if (!(std::abs(value) <= residualTolerance*scale))
+          accurate = false;
+      }
+
+      //the closed form loses the small roots when the root magnitudes are far apart
+      if (!accurate)
+        companion_roots<4, Scalar>(coeffs, roots);
+    }
+  };
+
+  // Computes the roots of a monic polynomial of compile-time degree N.
+  // Inputs:
+  //  coeffs: N coefficients of z^N + coeffs(N-1)*z^(N-1) + ... + coeffs(0), real or complex
+  // Outputs:
+  //  roots:  the N complex roots, unsorted
+  template <int N, typename Scalar>
+  IGL_INLINE void polynomial_roots(const Eigen::Matrix<Scalar, N, 1>& coeffs,
+                                   Eigen::Matrix<std::complex<double>, N, 1>& roots)
+  {
+    PolynomialRoots<N, Scalar>::compute(coeffs, roots);
+  }
+
+  // Version with the degree given at runtime (the size of coeffs), dispatching degrees up to 8 to the fixed-size solvers.
+  IGL_INLINE void polynomial_roots(const Eigen::VectorXcd& coeffs,
+                                   Eigen::VectorXcd& roots)
+  {
+    const int N = coeffs.size();
+    roots.resize(N);
+    switch (N){
+      case 0: break;
+#define DIRECTIONAL_POLYNOMIAL_ROOTS_CASE(n) \
+      case n: { \
+        Eigen::Matrix<std::complex<double>, n, 1> fixedRoots; \
+        polynomial_roots<n, std::complex<double> >(Eigen::Matrix<std::complex<double>, n, 1>(coeffs), fixedRoots); \
+        roots = fixedRoots; \
+        break; }
+      DIRECTIONAL_POLYNOMIAL_ROOTS_CASE(1)
+      DIRECTIONAL_POLYNOMIAL_ROOTS_CASE(2)
+      DIRECTIONAL_POLYNOMIAL_ROOTS_CASE(3)
+      DIRECTIONAL_POLYNOMIAL_ROOTS_CASE(4)
+      DIRECTIONAL_POLYNOMIAL_ROOTS_CASE(5)
+      DIRECTIONAL_POLYNOMIAL_ROOTS_CASE(6)
+      DIRECTIONAL_POLYNOMIAL_ROOTS_CASE(7)
+      DIRECTIONAL_POLYNOMIAL_ROOTS_CASE(8)
+#undef DIRECTIONAL_POLYNOMIAL_ROOTS_CASE
+      default: {
+        Eigen::MatrixXcd companion = Eigen::MatrixXcd::Zero(N, N);
+        companion.block(1, 0, N-1, N-1).setIdentity();
+        companion.col(N-1) = -coeffs;
+        roots = companion.eigenvalues();
+      }
+    }
+  }
+
+  // Computes the roots of many monic polynomials of the same compile-time degree in parallel, e.g. the polyvectors of all faces.
+  // Inputs:
+  //  coeffs: #P by N coefficients of each polynomial, lowest degree first
+  // Outputs:
+  //  roots:  #P by N complex roots of each polynomial, unsorted
+  template <int N>
+  IGL_INLINE void polynomial_roots_batch(const Eigen::MatrixXcd& coeffs,
+                                         Eigen::MatrixXcd& roots)
+  {
+    assert(coeffs.cols() == N);
+    roots.resize(coeffs.rows(), N);
+    igl::parallel_for(coeffs.rows(), [&](const int i)
+    {
+      Eigen::Matrix<std::complex<double>, N, 1> fixedRoots;
+      PolynomialRoots<N, std::complex<double> >::compute(coeffs.row(i).transpose(), fixedRoots);
+      roots.row(i) = fixedRoots.transpose();
+    }, 1000);
+  }
+}
+
+#endif
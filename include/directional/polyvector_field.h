@@ -11,6 +11,7 @@
 #include <Eigen/Geometry>
 #include <Eigen/Sparse>
 #include <Eigen/SparseCholesky>
+#include <Eigen/IterativeLinearSolvers>
 #include <Eigen/Eigenvalues>
 #include <unsupported/Eigen/Polynomials>
 #include <igl/triangle_triangle_adjacency.h>
@@ -18,92 +19,289 @@
 #include <igl/edge_topology.h>
 #include <igl/speye.h>
 #include <igl/eigs.h>
+#include <igl/parallel_for.h>
+#include <igl/Timer.h>
 #include <iostream>
+#include <vector>
+#include <directional/MeshContext.h>
 
 namespace directional
 {
   
-  // Precalculate the polyvector LDLt solvers. Must be recalculated whenever
-  // bc changes or the mesh changes.
+  // Solves with an initial guess where the solver supports it (iterative solvers), and ignores the guess otherwise.
+  template <class LinearSolver>
+  IGL_INLINE void solve_with_guess(const LinearSolver& solver,
+                                   const Eigen::VectorXcd& rhs,
+                                   const Eigen::VectorXcd& /*guess*/,
+                                   Eigen::VectorXcd& x)
+  {
+    x=solver.solve(rhs);
+  }
+  
+  template <class MatrixType, int UpLo, class Preconditioner>
+  IGL_INLINE void solve_with_guess(const Eigen::ConjugateGradient<MatrixType, UpLo, Preconditioner>& solver,
+                                   const Eigen::VectorXcd& rhs,
+                                   const Eigen::VectorXcd& guess,
+                                   Eigen::VectorXcd& x)
+  {
+    x=solver.solveWithGuess(rhs, guess);
+  }
+  
+  // The constraint-independent part of the polyvector system on a mesh: the energy matrix and its Hermitian normal matrix.
+  // It is assembled once per mesh and N, and reused by every precomputation with different constrained faces.
+  class PolyVectorSystemData
+  {
+  public:
+    int N, numF;
+    Eigen::SparseMatrix<std::complex<double>> Afull;  // full left-hand side (see polyvector_matrix())
+    Eigen::SparseMatrix<std::complex<double>> M;      // Afull^H*Afull
+    
+    // seconds spent in the phases of the last precomputation
+    double assemblyTime=0.0, restrictionTime=0.0, factorizationTime=0.0;
+  };
+  
+  // The complex representations of the common edge of an inner edge in the bases of its two faces, as used by the smoothness energy.
+  IGL_INLINE void polyvector_edge_directions(const Eigen::MatrixXd& V,
+                                             const Eigen::MatrixXi& EV,
+                                             const Eigen::MatrixXi& EF,
+                                             const Eigen::MatrixXd& B1,
+                                             const Eigen::MatrixXd& B2,
+                                             const int i,
+                                             std::complex<double>& ef,
+                                             std::complex<double>& eg)
+  {
+    using namespace Eigen;
+    RowVector3d e = V.row(EV(i,1)) - V.row(EV(i,0));
+    Vector2d vef = Vector2d(e.dot(B1.row(EF(i,0))), e.dot(B2.row(EF(i,0)))).normalized();
+    ef=std::complex<double>(vef(0), vef(1));
+    Vector2d veg = Vector2d(e.dot(B1.row(EF(i,1))), e.dot(B2.row(EF(i,1)))).normalized();
+    eg=std::complex<double>(veg(0), veg(1));
+  }
+  
+  // Builds the full left-hand side matrix of the polyvector smoothness energy, with a row for every inner edge and degree,
+  // and a column for every face and degree (ordered by degree, and then by face). Optionally also assembles the Hermitian
+  // normal matrix Afull^H*Afull directly, without a sparse product. The edges are processed in parallel.
   // Inputs:
   //  V:      #V by 3 vertex coordinates.
   //  F:      #F by 3 face vertex indices.
   //  EV:     #E by 2 matrix of edges (vertex indices)
   //  EF:     #E by 2 matrix of oriented adjacent faces
   //  B1, B2: #F by 3 matrices representing the local base of each face.
-  //  bc:     The face ids where the pv is prescribed.
   //  N:      The degree of the field.
   // Outputs:
-  //  solver:       with prefactorized left-hand side
-  //  AFull, AVar:  The resulting left-hand side matrices
-  IGL_INLINE void polyvector_precompute(const Eigen::MatrixXd& V,
-                                        const Eigen::MatrixXi& F,
-                                        const Eigen::MatrixXi& EV,
-                                        const Eigen::MatrixXi& EF,
-                                        const Eigen::MatrixXd& B1,
-                                        const Eigen::MatrixXd& B2,
-                                        const Eigen::VectorXi& bc,
-                                        const int N,
-                                        Eigen::SimplicialLDLT<Eigen::SparseMatrix<std::complex<double>>>& solver,
-                                        Eigen::SparseMatrix<std::complex<double>>& Afull,
-                                        Eigen::SparseMatrix<std::complex<double>>& AVar)
+  //  AFull:  The resulting left-hand side matrix
+  //  M:      (if not NULL) Afull^H*Afull
+  IGL_INLINE void polyvector_matrix(const Eigen::MatrixXd& V,
+                                    const Eigen::MatrixXi& F,
+                                    const Eigen::MatrixXi& EV,
+                                    const Eigen::MatrixXi& EF,
+                                    const Eigen::MatrixXd& B1,
+                                    const Eigen::MatrixXd& B2,
+                                    const int N,
+                                    Eigen::SparseMatrix<std::complex<double>>& Afull,
+                                    Eigen::SparseMatrix<std::complex<double>>* M=NULL)
   {
-    
     using namespace std;
     using namespace Eigen;
-    int rowCounter=0;
-    // Build the sparse matrix, with an energy term for each edge and degree
-    std::vector< Triplet<complex<double> > > AfullTriplets;
-    for (int n = 0; n < N; n++)
+    
+    std::vector<int> innerEdges;
+    for (int i=0;i<EF.rows();i++)
+      if ((EF(i,0)!=-1)&&(EF(i,1)!=-1))
+        innerEdges.push_back(i);
+    const int numInner=innerEdges.size();
+    
+    // Build the sparse matrix, with an energy term for each edge and degree. Every term has fixed slots in the triplet lists, so the edges are independent.
+    std::vector< Triplet<complex<double> > > AfullTriplets(2*N*numInner);
+    std::vector< Triplet<complex<double> > > MTriplets(M ? 4*N*numInner : 0);
+    igl::parallel_for(numInner, [&](const int k)
     {
-      for (int i=0;i<EF.rows();i++){
-        
-        if ((EF(i,0)==-1)||(EF(i,1)==-1))
-          continue;  //boundary edge
-        
-        // Compute the complex representation of the common edge
-        RowVector3d e = V.row(EV(i,1)) - V.row(EV(i,0));
-        RowVector2d vef = Vector2d(e.dot(B1.row(EF(i,0))), e.dot(B2.row(EF(i,0)))).normalized();
-        complex<double> ef(vef(0), vef(1));
-        Vector2d veg = Vector2d(e.dot(B1.row(EF(i,1))), e.dot(B2.row(EF(i,1)))).normalized();
-        complex<double> eg(veg(0), veg(1));
-        
+      int i=innerEdges[k];
+      complex<double> ef, eg;
+      polyvector_edge_directions(V, EV, EF, B1, B2, i, ef, eg);
+      
+      for (int n = 0; n < N; n++){
         // Add the term conj(f)^n*ui - conj(g)^n*uj to the energy matrix
-        AfullTriplets.push_back(Triplet<complex<double> >(rowCounter, n*F.rows()+EF(i,0), pow(conj(ef), N-n)));
-        AfullTriplets.push_back(Triplet<complex<double> >(rowCounter++, n*F.rows()+EF(i,1), -1.*pow(conj(eg), N-n)));
+        int row=n*numInner+k;
+        int colf=n*F.rows()+EF(i,0), colg=n*F.rows()+EF(i,1);
+        complex<double> af=pow(conj(ef), N-n), ag=-1.*pow(conj(eg), N-n);
+        AfullTriplets[2*row]=Triplet<complex<double> >(row, colf, af);
+        AfullTriplets[2*row+1]=Triplet<complex<double> >(row, colg, ag);
+        if (M){
+          MTriplets[4*row]=Triplet<complex<double> >(colf, colf, conj(af)*af);
+          MTriplets[4*row+1]=Triplet<complex<double> >(colg, colg, conj(ag)*ag);
+          MTriplets[4*row+2]=Triplet<complex<double> >(colf, colg, conj(af)*ag);
+          MTriplets[4*row+3]=Triplet<complex<double> >(colg, colf, conj(ag)*af);
+        }
       }
-    }
+    }, 1000);
     
-    
-    Afull.conservativeResize(rowCounter, N*F.rows());
+    Afull.resize(N*numInner, N*F.rows());
     Afull.setFromTriplets(AfullTriplets.begin(), AfullTriplets.end());
+    if (M){
+      M->resize(N*F.rows(), N*F.rows());
+      M->setFromTriplets(MTriplets.begin(), MTriplets.end());
+    }
+  }
+  
+  // Assembles the constraint-independent part of the polyvector system. Must be recalculated only when the mesh or N changes.
+  // Inputs:
+  //  V, F, EV, EF, B1, B2, N: as in polyvector_matrix().
+  // Outputs:
+  //  data:   the assembled system.
+  IGL_INLINE void polyvector_system(const Eigen::MatrixXd& V,
+                                    const Eigen::MatrixXi& F,
+                                    const Eigen::MatrixXi& EV,
+                                    const Eigen::MatrixXi& EF,
+                                    const Eigen::MatrixXd& B1,
+                                    const Eigen::MatrixXd& B2,
+                                    const int N,
+                                    PolyVectorSystemData& data)
+  {
+    igl::Timer timer;
+    timer.start();
+    data.N=N;
+    data.numF=F.rows();
+    polyvector_matrix(V, F, EV, EF, B1, B2, N, data.Afull, &data.M);
+    data.assemblyTime=timer.getElapsedTimeInSec();
+  }
+  
+  // Precalculate the polyvector LDLt solvers from an assembled system. Must be recalculated whenever bc changes.
+  // The system of the free variables is restricted from the assembled Hermitian matrix, rather than multiplied anew.
+  // Inputs:
+  //  bc:     The face ids where the pv is prescribed.
+  //  data:   The system assembled by polyvector_system().
+  // Outputs:
+  //  solver:       with prefactorized left-hand side (see below for the accepted solvers)
+  //  AFull, AVar:  The resulting left-hand side matrices
+  //  data:         with the timings of the restriction and factorization
+  template <class LinearSolver>
+  IGL_INLINE void polyvector_precompute(const Eigen::VectorXi& bc,
+                                        PolyVectorSystemData& data,
+                                        LinearSolver& solver,
+                                        Eigen::SparseMatrix<std::complex<double>>& Afull,
+                                        Eigen::SparseMatrix<std::complex<double>>& AVar)
+  {
+    using namespace std;
+    using namespace Eigen;
     
-    VectorXi constIndices(N*bc.size());
-    
-    for (int n=0;n<N;n++)
-      constIndices.segment(bc.rows()*n,bc.rows())=bc.array()+n*F.rows();
+    igl::Timer timer;
+    timer.start();
+    const int N=data.N;
+    const int numF=data.numF;
+    Afull=data.Afull;
     
     //removing columns pertaining to constant indices
-    VectorXi varMask=VectorXi::Constant(N*F.rows(),1);
-    for (int i=0;i<constIndices.size();i++)
-      varMask(constIndices(i))=0;
+    VectorXi varMask=VectorXi::Constant(N*numF,1);
+    for (int n=0;n<N;n++)
+      for (int i=0;i<bc.size();i++)
+        varMask(n*numF+bc(i))=0;
     
-    VectorXi full2var=VectorXi::Constant(N*F.rows(),-1);
+    VectorXi full2var=VectorXi::Constant(N*numF,-1);
     int varCounter=0;
-    for (int i=0;i<N*F.rows();i++)
+    for (int i=0;i<N*numF;i++)
       if (varMask(i))
         full2var(i)=varCounter++;
     
-    assert(varCounter==N*(F.rows()-bc.size()));
+    assert(varCounter==N*(numF-bc.size()));
     
     std::vector< Triplet<std::complex<double> > > AVarTriplets;
-    for (int i=0;i<AfullTriplets.size();i++)
-      if (full2var(AfullTriplets[i].col())!=-1)
-        AVarTriplets.push_back(Triplet<complex<double>>(AfullTriplets[i].row(), full2var(AfullTriplets[i].col()), AfullTriplets[i].value()));
+    AVarTriplets.reserve(Afull.nonZeros());
+    for (int k=0; k<Afull.outerSize(); ++k)
+      for (SparseMatrix<complex<double>>::InnerIterator it(Afull,k); it; ++it)
+        if (full2var(it.col())!=-1)
+          AVarTriplets.push_back(Triplet<complex<double>>(it.row(), full2var(it.col()), it.value()));
     
-    AVar.conservativeResize(rowCounter, N*(F.rows()-bc.size()));
+    AVar.resize(Afull.rows(), varCounter);
     AVar.setFromTriplets(AVarTriplets.begin(), AVarTriplets.end());
-    solver.compute(AVar.adjoint()*AVar);
+    
+    //AVar^H*AVar is the principal submatrix of Afull^H*Afull on the free variables
+    std::vector< Triplet<std::complex<double> > > MVarTriplets;
+    MVarTriplets.reserve(data.M.nonZeros());
+    for (int k=0; k<data.M.outerSize(); ++k)
+      for (SparseMatrix<complex<double>>::InnerIterator it(data.M,k); it; ++it)
+        if ((full2var(it.row())!=-1)&&(full2var(it.col())!=-1))
+          MVarTriplets.push_back(Triplet<complex<double>>(full2var(it.row()), full2var(it.col()), it.value()));
+    
+    SparseMatrix<complex<double>> MVar(varCounter, varCounter);
+    MVar.setFromTriplets(MVarTriplets.begin(), MVarTriplets.end());
+    data.restrictionTime=timer.getElapsedTimeInSec();
+    
+    timer.start();
+    solver.compute(MVar);
+    data.factorizationTime=timer.getElapsedTimeInSec();
+  }
+  
+  // Precalculate the polyvector LDLt solvers. Must be recalculated whenever
+  // bc changes or the mesh changes.
+  // Inputs:
+  //  V:      #V by 3 vertex coordinates.
+  //  F:      #F by 3 face vertex indices.
+  //  EV:     #E by 2 matrix of edges (vertex indices)
+  //  EF:     #E by 2 matrix of oriented adjacent faces
+  //  B1, B2: #F by 3 matrices representing the local base of each face.
+  //  bc:     The face ids where the pv is prescribed.
+  //  N:      The degree of the field.
+  // Outputs:
+  //  solver:       with prefactorized left-hand side. Any Eigen sparse solver for a Hermitian positive definite complex matrix can be used
+  //                (e.g., Eigen::SimplicialLDLT, Eigen::SimplicialLLT, Eigen::CholmodSupernodalLLT if CHOLMOD is available, or Eigen::ConjugateGradient)
+  //  AFull, AVar:  The resulting left-hand side matrices
+  template <class LinearSolver>
+  IGL_INLINE void polyvector_precompute(const Eigen::MatrixXd& V,
+                                        const Eigen::MatrixXi& F,
+                                        const Eigen::MatrixXi& EV,
+                                        const Eigen::MatrixXi& EF,
+                                        const Eigen::MatrixXd& B1,
+                                        const Eigen::MatrixXd& B2,
+                                        const Eigen::VectorXi& bc,
+                                        const int N,
+                                        LinearSolver& solver,
+                                        Eigen::SparseMatrix<std::complex<double>>& Afull,
+                                        Eigen::SparseMatrix<std::complex<double>>& AVar)
+  {
+    PolyVectorSystemData data;
+    polyvector_system(V, F, EV, EF, B1, B2, N, data);
+    polyvector_precompute(bc, data, solver, Afull, AVar);
+  }
+  
+  
+  // Computes the polyvector coefficients that are prescribed by the given directionals.
+  // Inputs:
+  //  B1, B2:       #F by 3 matrices representing the local base of each face.
+  //  bc:           The faces on which the polyvector is prescribed.
+  //  b:            The directionals on the faces indicated by bc, in either #bc by 3N raw format or #bc by 3 representative format (implying N-RoSy)
+  //  N:            The degree of the field.
+  // Outputs:
+  //  constValuesMat: #bc by N prescribed coefficients (the free coefficient first).
+  IGL_INLINE void polyvector_constraint_values(const Eigen::MatrixXd& B1,
+                                               const Eigen::MatrixXd& B2,
+                                               const Eigen::VectorXi& bc,
+                                               const Eigen::MatrixXd& b,
+                                               const int N,
+                                               Eigen::MatrixXcd& constValuesMat)
+  {
+    using namespace std;
+    using namespace Eigen;
+    
+    constValuesMat.resize(b.rows(),N);
+    assert((b.cols()==3*N)||(b.cols()==3));
+    if (b.cols()==3)  //N-RoSy constraint
+    {
+      constValuesMat.setZero();
+      for (int i=0;i<b.rows();i++){
+        complex<double> bComplex=complex<double>(b.row(i).dot(B1.row(bc(i))), b.row(i).dot(B2.row(bc(i))));
+        constValuesMat(i,0)=-pow(bComplex, N);
+      }
+    } else {
+      for (int i=0;i<b.rows();i++){
+        RowVectorXcd poly,roots(N);
+        for (int n=0;n<N;n++){
+          RowVector3d vec=b.block(i,3*n,1,3);
+          roots(n)=complex<double>(vec.dot(B1.row(bc(i))), vec.dot(B2.row(bc(i))));
+        }
+        roots_to_monicPolynomial(roots, poly);
+        constValuesMat.row(i)<<poly.head(N);
+      }
+    }
   }
   
   
@@ -117,13 +315,15 @@ namespace directional
   //  solver:       With prefactorized left-hand side
   //  Afull, AVar:  Left-hand side matrices (with and without constraints) of the system
   //  N:            The degree of the field.
+  //  polyVectorField: if the solver is iterative and this is already #F by N, it is used as the initial guess (warm start).
   // Outputs:
   //  polyVectorField: #F by N The output interpolated field, in polyvector (complex polynomial) format.
+  template <class LinearSolver>
   IGL_INLINE void polyvector_field(const Eigen::MatrixXd& B1,
                                    const Eigen::MatrixXd& B2,
                                    const Eigen::VectorXi& bc,
                                    const Eigen::MatrixXd& b,
-                                   const Eigen::SimplicialLDLT<Eigen::SparseMatrix<std::complex<double>>>& solver,
+                                   const LinearSolver& solver,
                                    const Eigen::SparseMatrix<std::complex<double>>& Afull,
                                    const Eigen::SparseMatrix<std::complex<double>>& AVar,
                                    const int N,
@@ -178,26 +378,8 @@ namespace directional
       return;
     }
     
-    MatrixXcd constValuesMat(b.rows(),N);
-    assert((b.cols()==3*N)||(b.cols()==3));
-    if (b.cols()==3)  //N-RoSy constraint
-    {
-      constValuesMat.setZero();
-      for (int i=0;i<b.rows();i++){
-        complex<double> bComplex=complex<double>(b.row(i).dot(B1.row(bc(i))), b.row(i).dot(B2.row(bc(i))));
-        constValuesMat(i,0)=-pow(bComplex, N);
-      }
-    } else {
-      for (int i=0;i<b.rows();i++){
-        RowVectorXcd poly,roots(N);
-        for (int n=0;n<N;n++){
-          RowVector3d vec=b.block(i,3*n,1,3);
-          roots(n)=complex<double>(vec.dot(B1.row(bc(i))), vec.dot(B2.row(bc(i))));
-        }
-        roots_to_monicPolynomial(roots, poly);
-        constValuesMat.row(i)<<poly.head(N);
-      }
-    }
+    MatrixXcd constValuesMat;
+    polyvector_constraint_values(B1, B2, bc, b, N, constValuesMat);
     
     VectorXi constIndices(N*bc.size());
     VectorXcd constValues(N*b.size());
@@ -213,8 +395,6 @@ namespace directional
       torhs(constIndices(i))=constValues(i);
     
     VectorXcd rhs=-AVar.adjoint()*Afull*torhs;
-    VectorXcd varFieldVector=solver.solve(rhs);
-    assert(solver.info() == Success);
     
     VectorXcd polyVectorFieldVector(N*B1.rows());
     VectorXi varMask=VectorXi::Constant(N*B1.rows(),1);
@@ -229,6 +409,18 @@ namespace directional
     
     assert(varCounter==N*(B1.rows()-bc.size()));
     
+    VectorXcd varFieldVector;
+    if ((polyVectorField.rows()==B1.rows())&&(polyVectorField.cols()==N)){
+      VectorXcd guess(varCounter);
+      for (int n=0;n<N;n++)
+        for (int i=0;i<B1.rows();i++)
+          if (full2var(n*B1.rows()+i)!=-1)
+            guess(full2var(n*B1.rows()+i))=polyVectorField(i,n);
+      solve_with_guess(solver, rhs, guess, varFieldVector);
+    } else
+      varFieldVector=solver.solve(rhs);
+    assert(solver.info() == Success);
+    
     for (int i=0;i<constIndices.size();i++)
       polyVectorFieldVector(constIndices(i))=constValues(i);
     
@@ -244,7 +436,75 @@ namespace directional
   }
   
   
-  // minimal version without auxiliary data
+  // Computes several polyvector fields that share the constrained faces bc, but with different prescribed values, with a single
+  // multi-right-hand-side solve against the factorization of polyvector_precompute.
+  // Inputs:
+  //  B1, B2:       #F by 3 matrices representing the local base of each face.
+  //  bc:           The faces on which the polyvectors are prescribed (must be nonempty).
+  //  bSets:        K sets of directionals on the faces indicated by bc, each in either format accepted by the single-field version.
+  //  solver:       With prefactorized left-hand side
+  //  Afull, AVar:  Left-hand side matrices (with and without constraints) of the system
+  //  N:            The degree of the fields.
+  // Outputs:
+  //  polyVectorFields: K #F by N output interpolated fields, in polyvector (complex polynomial) format.
+  template <class LinearSolver>
+  IGL_INLINE void polyvector_field(const Eigen::MatrixXd& B1,
+                                   const Eigen::MatrixXd& B2,
+                                   const Eigen::VectorXi& bc,
+                                   const std::vector<Eigen::MatrixXd>& bSets,
+                                   const LinearSolver& solver,
+                                   const Eigen::SparseMatrix<std::complex<double>>& Afull,
+                                   const Eigen::SparseMatrix<std::complex<double>>& AVar,
+                                   const int N,
+                                   std::vector<Eigen::MatrixXcd>& polyVectorFields)
+  {
+    using namespace std;
+    using namespace Eigen;
+    
+    assert(bc.size()!=0);
+    assert(solver.rows()!=0);
+    
+    const int numF=B1.rows();
+    const int K=bSets.size();
+    
+    VectorXi full2var=VectorXi::Constant(N*numF,0);
+    for (int n=0;n<N;n++)
+      for (int i=0;i<bc.size();i++)
+        full2var(n*numF+bc(i))=-1;
+    int varCounter=0;
+    for (int i=0;i<N*numF;i++)
+      if (full2var(i)!=-1)
+        full2var(i)=varCounter++;
+    
+    assert(varCounter==N*(numF-bc.size()));
+    
+    //the constrained values of all fields, as columns
+    MatrixXcd torhs=MatrixXcd::Zero(N*numF, K);
+    for (int k=0;k<K;k++){
+      assert(bc.size()==bSets[k].rows());
+      MatrixXcd constValuesMat;
+      polyvector_constraint_values(B1, B2, bc, bSets[k], N, constValuesMat);
+      for (int n=0;n<N;n++)
+        for (int i=0;i<bc.size();i++)
+          torhs(n*numF+bc(i),k)=constValuesMat(i,n);
+    }
+    
+    MatrixXcd rhs=-AVar.adjoint()*(Afull*torhs);
+    MatrixXcd varFieldVectors=solver.solve(rhs);
+    assert(solver.info() == Success);
+    
+    polyVectorFields.resize(K);
+    for (int k=0;k<K;k++){
+      polyVectorFields[k].resize(numF,N);
+      for (int n=0;n<N;n++)
+        for (int i=0;i<numF;i++)
+          polyVectorFields[k](i,n)=(full2var(n*numF+i)==-1 ? torhs(n*numF+i,k) : varFieldVectors(full2var(n*numF+i),k));
+    }
+  }
+  
+  
+  // minimal version without auxiliary data. The linear solver can be chosen by the template parameter.
+  template <class LinearSolver=Eigen::SimplicialLDLT<Eigen::SparseMatrix<std::complex<double>>>>
   IGL_INLINE void polyvector_field(const Eigen::MatrixXd& V,
                                    const Eigen::MatrixXi& F,
                                    const Eigen::VectorXi& bc,
@@ -257,9 +517,43 @@ namespace directional
     Eigen::MatrixXd B1, B2, xd;
     igl::local_basis(V, F, B1, B2, xd);
     Eigen::SparseMatrix<std::complex<double>> Afull, AVar;
-    Eigen::SimplicialLDLT<Eigen::SparseMatrix<std::complex<double>>> solver;
+    LinearSolver solver;
     polyvector_precompute(V,F,EV,EF,B1,B2,bc,N, solver,Afull,AVar);
     polyvector_field(B1, B2, bc, b, solver, Afull, AVar, N, polyVectorField);
   }
+  
+  // Precomputation with the topology and local basis taken from a MeshContext.
+  template <class LinearSolver>
+  IGL_INLINE void polyvector_precompute(const MeshContext& mesh,
+                                        const Eigen::VectorXi& bc,
+                                        const int N,
+                                        LinearSolver& solver,
+                                        Eigen::SparseMatrix<std::complex<double>>& Afull,
+                                        Eigen::SparseMatrix<std::complex<double>>& AVar)
+  {
+    polyvector_precompute(mesh.V, mesh.F, mesh.EV(), mesh.EF(), mesh.B1(), mesh.B2(), bc, N, solver, Afull, AVar);
+  }
+  
+  // Version with the topology and local basis taken from a MeshContext.
+  IGL_INLINE void polyvector_system(const MeshContext& mesh,
+                                    const int N,
+                                    PolyVectorSystemData& data)
+  {
+    polyvector_system(mesh.V, mesh.F, mesh.EV(), mesh.EF(), mesh.B1(), mesh.B2(), N, data);
+  }
+  
+  // minimal version with the topology and local basis taken from a MeshContext.
+  template <class LinearSolver=Eigen::SimplicialLDLT<Eigen::SparseMatrix<std::complex<double>>>>
+  IGL_INLINE void polyvector_field(const MeshContext& mesh,
+                                   const Eigen::VectorXi& bc,
+                                   const Eigen::MatrixXd& b,
+                                   const int N,
+                                   Eigen::MatrixXcd& polyVectorField)
+  {
+    Eigen::SparseMatrix<std::complex<double>> Afull, AVar;
+    LinearSolver solver;
+    polyvector_precompute(mesh, bc, N, solver, Afull, AVar);
+    polyvector_field(mesh.B1(), mesh.B2(), bc, b, solver, Afull, AVar, N, polyVectorField);
+  }
 }
 #endif
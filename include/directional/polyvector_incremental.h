@@ -0,0 +1,279 @@
+// This file is part of Directional, a library for directional field processing.
+// Copyright (C) 2018 Amir Vaxman <avaxman@gmail.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef DIRECTIONAL_POLYVECTOR_INCREMENTAL_H
+#define DIRECTIONAL_POLYVECTOR_INCREMENTAL_H
+
+#include <vector>
+#include <algorithm>
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+#include <Eigen/SparseCholesky>
+#include <Eigen/LU>
+#include <igl/igl_inline.h>
+#include <directional/polyvector_field.h>
+#include <directional/MeshContext.h>
+
+namespace directional
+{
+  // Data for computing polyvector (and power) fields under constraints that change one face at a time, as in interactive editing.
+  // The smoothness system is factorized once, and the hard constraints are imposed through a small dense bordered system on the
+  // constrained variables, which is extended with N solves when a face is added and shrunk with no solves when a face is removed.
+  // The smoothness matrix M is singular when the mesh admits parallel fields. Instead of regularizing it, one anchor face of every
+  // connected component is pinned with a penalty, M+w*E*E^H, which is definite, and the penalty is removed exactly by the rows of the
+  // anchor variables in the bordered system:
+  //  [E^H*K*E-I/w  E^H*K*P^T] [s     ]   [0]
+  //  [P*K*E        P*K*P^T  ] [lambda] = [c],  x = K*(E*s+P^T*lambda),  K = (M+w*E*E^H)^-1
+  // where P selects the constrained variables and E the anchor variables.
+  class PolyVectorIncrementalData
+  {
+  public:
+    int N, numF;
+    Eigen::MatrixXd B1, B2;
+
+    // Full left-hand side, and the factorization of Afull^H*Afull with the penalized anchors
+    Eigen::SparseMatrix<std::complex<double>> Afull;
+    Eigen::SimplicialLDLT<Eigen::SparseMatrix<std::complex<double>>> solver;
+    double anchorWeight;
+    std::vector<int> anchorVars;           // the N variables of the anchor face of each component
+
+    // Current constraints, in the order they were added
+    std::vector<int> constFaces;
+    Eigen::MatrixXcd constValuesMat;  // #constFaces by N prescribed coefficients
+
+    // The bordered system, ordered by the anchor variables and then by constrained face and degree, and its factorization
+    Eigen::MatrixXcd borderedMatrix;
+    Eigen::FullPivLU<Eigen::MatrixXcd> borderedSolver;
+  };
+
+  // Precomputes the factorization of the unconstrained system. Must be recalculated only when the mesh or N changes.
+  // Inputs:
+  //  V:      #V by 3 vertex coordinates.
+  //  F:      #F by 3 face vertex indices.
+  //  EV:     #E by 2 matrix of edges (vertex indices)
+  //  EF:     #E by 2 matrix of oriented adjacent faces
+  //  B1, B2: #F by 3 matrices representing the local base of each face.
+  //  N:      The degree of the field.
+  // Outputs:
+  //  data:   factorized system with an empty constraint set.
+  IGL_INLINE void polyvector_incremental_precompute(const Eigen::MatrixXd& V,
+                                                    const Eigen::MatrixXi& F,
+                                                    const Eigen::MatrixXi& EV,
+                                                    const Eigen::MatrixXi& EF,
+                                                    const Eigen::MatrixXd& B1,
+                                                    const Eigen::MatrixXd& B2,
+                                                    const int N,
+                                                    PolyVectorIncrementalData& data)
+  {
+    using namespace Eigen;
+    typedef std::complex<double> Complex;
+
+    data.N=N;
+    data.numF=F.rows();
+    data.B1=B1;
+    data.B2=B2;
+    SparseMatrix<Complex> M;
+    polyvector_matrix(V, F, EV, EF, B1, B2, N, data.Afull, &M);
+
+    //the first face of every connected component (through inner edges) is its anchor
+    std::vector<std::vector<int> > adjFaces(F.rows());
+    for (int i=0;i<EF.rows();i++)
+      if ((EF(i,0)!=-1)&&(EF(i,1)!=-1)){
+        adjFaces[EF(i,0)].push_back(EF(i,1));
+        adjFaces[EF(i,1)].push_back(EF(i,0));
+      }
+    std::vector<bool> visited(F.rows(), false);
+    std::vector<int> anchorFaces, front;
+    for (int i=0;i<F.rows();i++){
+      if (visited[i])
+        continue;
+      anchorFaces.push_back(i);
+      visited[i]=true;
+      front.assign(1,i);
+      while (!front.empty()){
+        int f=front.back();
+        front.pop_back();
+        for (int k=0;k<adjFaces[f].size();k++)
+          if (!visited[adjFaces[f][k]]){
+            visited[adjFaces[f][k]]=true;
+            front.push_back(adjFaces[f][k]);
+          }
+      }
+    }
+
+    data.anchorVars.clear();
+    for (int n=0;n<N;n++)
+      for (int i=0;i<anchorFaces.size();i++)
+        data.anchorVars.push_back(n*data.numF+anchorFaces[i]);
+
+    //the penalty is on the scale of the diagonal, so that the penalized system is as well conditioned as one with a single constrained face
+    VectorXcd diagM=M.diagonal();
+    data.anchorWeight=(diagM.size()>0 ? diagM.real().mean() : 1.0);
+    if (data.anchorWeight<=0.0)
+      data.anchorWeight=1.0;
+    std::vector<Triplet<Complex>> anchorTriplets;
+    for (int i=0;i<data.anchorVars.size();i++)
+      anchorTriplets.push_back(Triplet<Complex>(data.anchorVars[i], data.anchorVars[i], Complex(data.anchorWeight,0.0)));
+    SparseMatrix<Complex> anchorMat(M.rows(), M.cols());
+    anchorMat.setFromTriplets(anchorTriplets.begin(), anchorTriplets.end());
+    data.solver.compute(M+anchorMat);
+    assert(data.solver.info() == Success);
+
+    //only the anchor rows of each column of K*E are kept
+    int numAnchors=data.anchorVars.size();
+    data.borderedMatrix.resize(numAnchors, numAnchors);
+    VectorXcd unitVector=VectorXcd::Zero(N*data.numF);
+    for (int j=0;j<numAnchors;j++){
+      unitVector(data.anchorVars[j])=1.0;
+      VectorXcd anchorColumn=data.solver.solve(unitVector);
+      unitVector(data.anchorVars[j])=0.0;
+      for (int i=0;i<numAnchors;i++)
+        data.borderedMatrix(i,j)=anchorColumn(data.anchorVars[i]);
+    }
+    data.borderedMatrix.diagonal().array()-=1.0/data.anchorWeight;
+    data.borderedSolver.compute(data.borderedMatrix);
+
+    data.constFaces.clear();
+    data.constValuesMat.resize(0,N);
+  }
+
+  // Version with the topology and local basis taken from a MeshContext.
+  IGL_INLINE void polyvector_incremental_precompute(const MeshContext& mesh,
+                                                    const int N,
+                                                    PolyVectorIncrementalData& data)
+  {
+    polyvector_incremental_precompute(mesh.V, mesh.F, mesh.EV(), mesh.EF(), mesh.B1(), mesh.B2(), N, data);
+  }
+
+  // Adds a constrained face, or changes the prescribed directional of an already-constrained face.
+  // Inputs:
+  //  face:   the face to constrain.
+  //  b:      the directional on the face, in either 3N raw format or 3 representative format (implying N-RoSy), as in polyvector_field.
+  //  data:   precomputed with polyvector_incremental_precompute.
+  // Outputs:
+  //  data:   with the updated constraint set.
+  IGL_INLINE void polyvector_incremental_set_constraint(const int face,
+                                                        const Eigen::RowVectorXd& b,
+                                                        PolyVectorIncrementalData& data)
+  {
+    using namespace Eigen;
+
+    const int N=data.N;
+    MatrixXcd values;
+    polyvector_constraint_values(data.B1, data.B2, VectorXi::Constant(1,face), MatrixXd(b), N, values);
+
+    std::vector<int>::iterator fi=std::find(data.constFaces.begin(), data.constFaces.end(), face);
+    if (fi!=data.constFaces.end()){
+      data.constValuesMat.row(fi-data.constFaces.begin())=values.row(0);
+      return;
+    }
+
+    data.constFaces.push_back(face);
+    data.constValuesMat.conservativeResize(data.constFaces.size(), N);
+    data.constValuesMat.row(data.constFaces.size()-1)=values.row(0);
+
+    //the columns of K that pertain to the new variables, restricted to the anchor and to all constrained variables
+    int numAnchors=data.anchorVars.size();
+    int numBordered=numAnchors+N*data.constFaces.size();
+    MatrixXcd newColumns(numBordered, N);
+    for (int n=0;n<N;n++){
+      VectorXcd unitVector=VectorXcd::Zero(N*data.numF);
+      unitVector(n*data.numF+face)=1.0;
+      VectorXcd invColumn=data.solver.solve(unitVector);
+      for (int j=0;j<numAnchors;j++)
+        newColumns(j, n)=invColumn(data.anchorVars[j]);
+      for (int i=0;i<data.constFaces.size();i++)
+        for (int m=0;m<N;m++)
+          newColumns(numAnchors+i*N+m, n)=invColumn(m*data.numF+data.constFaces[i]);
+    }
+
+    data.borderedMatrix.conservativeResize(numBordered, numBordered);
+    data.borderedMatrix.rightCols(N)=newColumns;
+    data.borderedMatrix.bottomLeftCorner(N, numBordered-N)=newColumns.topRows(numBordered-N).adjoint();
+    data.borderedSolver.compute(data.borderedMatrix);
+  }
+
+  // Removes a constrained face. Nothing happens if the face is not constrained.
+  IGL_INLINE void polyvector_incremental_remove_constraint(const int face,
+                                                           PolyVectorIncrementalData& data)
+  {
+    using namespace Eigen;
+
+    std::vector<int>::iterator fi=std::find(data.constFaces.begin(), data.constFaces.end(), face);
+    if (fi==data.constFaces.end())
+      return;
+
+    const int N=data.N;
+    int slot=fi-data.constFaces.begin();
+    int numAnchors=data.anchorVars.size();
+    int numBordered=numAnchors+N*(data.constFaces.size()-1);
+
+    VectorXi remainIndices(numBordered);
+    for (int j=0;j<numAnchors;j++)
+      remainIndices(j)=j;
+    for (int i=0, counter=numAnchors;i<data.constFaces.size();i++)
+      if (i!=slot)
+        for (int n=0;n<N;n++)
+          remainIndices(counter++)=numAnchors+i*N+n;
+
+    MatrixXcd newBorderedMatrix(numBordered, numBordered);
+    for (int j=0;j<numBordered;j++)
+      for (int i=0;i<numBordered;i++)
+        newBorderedMatrix(i,j)=data.borderedMatrix(remainIndices(i), remainIndices(j));
+    data.borderedMatrix=newBorderedMatrix;
+    data.borderedSolver.compute(data.borderedMatrix);
+
+    MatrixXcd newConstValuesMat(data.constFaces.size()-1, N);
+    for (int i=0, counter=0;i<data.constFaces.size();i++)
+      if (i!=slot)
+        newConstValuesMat.row(counter++)=data.constValuesMat.row(i);
+    data.constValuesMat=newConstValuesMat;
+    data.constFaces.erase(fi);
+  }
+
+  // Computes the polyvector field that interpolates the current constraints, with a solve of the factorized bordered system and a single
+  // solve against the precomputed factorization. The result equals that of polyvector_field() with the same constraints, and the constraints
+  // are satisfied to the accuracy of the solves. If no constraints are given the zero field is returned.
+  // Inputs:
+  //  data:   with the current constraint set.
+  // Outputs:
+  //  polyVectorField: #F by N The output interpolated field, in polyvector (complex polynomial) format.
+  IGL_INLINE void polyvector_incremental_field(const PolyVectorIncrementalData& data,
+                                               Eigen::MatrixXcd& polyVectorField)
+  {
+    using namespace Eigen;
+
+    const int N=data.N;
+    polyVectorField=MatrixXcd::Zero(data.numF, N);
+    if (data.constFaces.empty())
+      return;
+
+    int numAnchors=data.anchorVars.size();
+    VectorXcd borderedRhs=VectorXcd::Zero(numAnchors+N*data.constFaces.size());
+    for (int i=0;i<data.constFaces.size();i++)
+      for (int n=0;n<N;n++)
+        borderedRhs(numAnchors+i*N+n)=data.constValuesMat(i,n);
+
+    //the anchor penalty forces and the Lagrange multipliers of the hard constraints
+    VectorXcd multipliers=data.borderedSolver.solve(borderedRhs);
+
+    VectorXcd rhs=VectorXcd::Zero(N*data.numF);
+    for (int j=0;j<numAnchors;j++)
+      rhs(data.anchorVars[j])+=multipliers(j);
+    for (int i=0;i<data.constFaces.size();i++)
+      for (int n=0;n<N;n++)
+        rhs(n*data.numF+data.constFaces[i])+=multipliers(numAnchors+i*N+n);
+
+    VectorXcd polyVectorFieldVector=data.solver.solve(rhs);
+    assert(data.solver.info() == Success);
+
+    for (int n=0;n<N;n++)
+      polyVectorField.col(n)=polyVectorFieldVector.segment(n*data.numF, data.numF);
+  }
+}
+
+#endif
@@ -0,0 +1,389 @@
+// This file is part of Directional, a library for directional field processing.
+// Copyright (C) 2018 Amir Vaxman <avaxman@gmail.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef DIRECTIONAL_POLYVECTOR_MULTIGRID_H
+#define DIRECTIONAL_POLYVECTOR_MULTIGRID_H
+
+#include <cmath>
+#include <vector>
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+#include <Eigen/SparseCholesky>
+#include <igl/igl_inline.h>
+#include <igl/local_basis.h>
+#include <directional/polyvector_field.h>
+#include <directional/SubdivisionInternal/shm_edge_topology.h>
+#include <directional/SubdivisionInternal/build_directional_subdivision_operators.h>
+#include <directional/SubdivisionInternal/shm_halfcurl_coefficients.h>
+#include <directional/SubdivisionInternal/shm_oneform_coefficients.h>
+#include <directional/SubdivisionInternal/Sc_directional_triplet_provider.h>
+#include <directional/SubdivisionInternal/Se_directional_triplet_provider.h>
+#include <directional/SubdivisionInternal/Gamma_suite.h>
+#include <directional/SubdivisionInternal/DirectionalGamma_Suite.h>
+
+namespace directional
+{
+  // Data for computing polyvector (and power) fields on a mesh with subdivision connectivity with a multigrid-preconditioned conjugate gradient,
+  // in time and memory that grow linearly with the fine mesh, rather than with a direct factorization of the fine system.
+  // The levels are the nested meshes whose quadrisection gives the input mesh, where the vertices of every level are the first vertices of the next.
+  // Coarse coefficients are prolongated with the stencil weights of the directional subdivision operator of vector fields, rotated into the
+  // fine bases by the power of the basis rotation that matches the degree of every coefficient. The coarse systems are the Galerkin products
+  // of the fine system with the prolongations. Only the coarsest system is factorized.
+  class PolyVectorMultigridData
+  {
+  public:
+    int N, numLevels;
+
+    // The input mesh, on which the field is computed
+    Eigen::MatrixXd V, B1, B2;
+    Eigen::MatrixXi F, EV, EF;
+    Eigen::SparseMatrix<std::complex<double>> Afull, M;   // energy matrix and its normal matrix Afull^H*Afull
+
+    // prolongations[l] maps the coefficients of level l to those of level l+1 (level 0 is the coarsest mesh, and level numLevels is V,F)
+    std::vector<Eigen::SparseMatrix<std::complex<double>>> prolongations;
+
+    // The hierarchy for the current constrained faces (set by polyvector_multigrid_set_constraints())
+    Eigen::VectorXi bc;
+    Eigen::VectorXi isConstrained;      // N*#F, 1 for the prescribed coefficients
+    std::vector<Eigen::SparseMatrix<std::complex<double>>> levelMatrices;       // system of every level
+    std::vector<Eigen::SparseMatrix<std::complex<double>>> levelProlongations;  // prolongations that do not change prescribed coefficients
+    std::vector<Eigen::VectorXd> invDiagonals;
+    Eigen::SimplicialLDLT<Eigen::SparseMatrix<std::complex<double>>> coarseSolver;
+
+    // Solver parameters
+    int smoothingSteps=2;         // weighted Jacobi steps before and after every coarse correction
+    double jacobiWeight=0.6;
+    int maxIterations=500;
+    double tolerance=1e-8;        // relative residual
+
+    // Statistics of the last solve
+    int iterations=0;
+    double residual=0.0;
+  };
+
+
+  // Precomputes the constraint-independent multigrid hierarchy of a mesh with subdivision connectivity. Must be recalculated only when the mesh or N changes.
+  // Inputs:
+  //  V:          #V by 3 vertex coordinates of the mesh on which the field is computed.
+  //  F:          #F by 3 face vertex indices, which must be exactly FCoarse quadrisected numLevels times by the subdivision operators,
+  //              where the new vertices of every level are numbered after those of the previous one.
+  //  FCoarse:    #FCoarse by 3 face vertex indices of the coarsest level, whose vertices are the first ones of V.
+  //  numLevels:  number of quadrisections from FCoarse to F.
+  //  N:          The degree of the field.
+  // Outputs:
+  //  data:       the hierarchy.
+  // Returns:
+  //  whether F and V are the quadrisection of FCoarse, and the mesh is closed as the directional subdivision operators require (otherwise data is not usable).
+  IGL_INLINE bool polyvector_multigrid_precompute(const Eigen::MatrixXd& V,
+                                                  const Eigen::MatrixXi& F,
+                                                  const Eigen::MatrixXi& FCoarse,
+                                                  const int numLevels,
+                                                  const int N,
+                                                  PolyVectorMultigridData& data)
+  {
+    using namespace std;
+    using namespace Eigen;
+    typedef complex<double> Complex;
+
+    data.N=N;
+    data.numLevels=numLevels;
+    data.prolongations.resize(numLevels);
+
+    auto Sc_directional_provider = directional_triplet_provider_wrapper<coefficient_provider_t>(subdivision::shm_halfcurl_coefficients, subdivision::Sc_directional_triplet_provider<coefficient_provider_t>);
+    auto Se_directional_provider = directional_triplet_provider_wrapper<coefficient_provider_t>(subdivision::shm_oneform_coefficients, subdivision::Se_directional_triplet_provider<coefficient_provider_t>);
+
+    MatrixXi FLevel=FCoarse, EVLevel, EFLevel, EILevel, SFELevel;
+    int numVLevel=FCoarse.maxCoeff()+1;
+    if (numVLevel>V.rows())
+      return false;
+    shm_edge_topology(FLevel, numVLevel, EVLevel, EFLevel, EILevel, SFELevel);
+    if ((EFLevel.array()==-1).any())
+      return false;
+    MatrixXd B1Level, B2Level, B3Level;
+    igl::local_basis(V.topRows(numVLevel), FLevel, B1Level, B2Level, B3Level);
+
+    for (int l=0;l<numLevels;l++){
+      //the vector field subdivision operator of the level, with a trivial matching
+      MatrixXi FNext, EVNext, EFNext, EINext, SFENext;
+      VectorXi matching=VectorXi::Zero(EVLevel.rows()), matchingNext;
+      std::vector<SparseMatrix<double>> decompOperators;
+      build_directional_subdivision_operators(V.topRows(numVLevel), FLevel, EVLevel, EFLevel, EILevel, SFELevel, matching,
+                                              std::vector<int>({(int)EVLevel.rows(), (int)EVLevel.rows()}), 1, 1,
+                                              FNext, EVNext, EFNext, EINext, SFENext, matchingNext, decompOperators,
+                                              Se_directional_provider, Sc_directional_provider);
+      int numVNext=numVLevel+EVLevel.rows();
+      if (numVNext>V.rows())
+        return false;
+
+      SparseMatrix<double> rawToG2, G2ToDecomp, decompSubdivision, decompToG2, G2ToRaw;
+      columndirectional_to_gamma2_matrix(V.topRows(numVLevel), FLevel, EVLevel, SFELevel, EFLevel, 1, rawToG2);
+      Matched_Gamma2_To_AC(EILevel, EFLevel, SFELevel, matching, 1, G2ToDecomp);
+      block_diag({&decompOperators[0], &decompOperators[1]}, decompSubdivision);
+      Matched_AC_To_Gamma2(EFNext, SFENext, EINext, matchingNext, 1, decompToG2);
+      Gamma2_reprojector(V.topRows(numVNext), FNext, EVNext, SFENext, EFNext, G2ToRaw);
+
+      MatrixXd B1Next, B2Next, B3Next;
+      igl::local_basis(V.topRows(numVNext), FNext, B1Next, B2Next, B3Next);
+      SparseMatrix<double> localToRaw, rawToLocalNext;
+      std::vector<Triplet<double>> basisTriplets;
+      for (int f=0;f<FLevel.rows();f++)
+        for (int i=0;i<3;i++){
+          basisTriplets.push_back(Triplet<double>(3*f+i, 2*f, B1Level(f,i)));
+          basisTriplets.push_back(Triplet<double>(3*f+i, 2*f+1, B2Level(f,i)));
+        }
+      localToRaw.resize(3*FLevel.rows(), 2*FLevel.rows());
+      localToRaw.setFromTriplets(basisTriplets.begin(), basisTriplets.end());
+      basisTriplets.clear();
+      for (int f=0;f<FNext.rows();f++)
+        for (int i=0;i<3;i++){
+          basisTriplets.push_back(Triplet<double>(2*f, 3*f+i, B1Next(f,i)));
+          basisTriplets.push_back(Triplet<double>(2*f+1, 3*f+i, B2Next(f,i)));
+        }
+      rawToLocalNext.resize(2*FNext.rows(), 3*FNext.rows());
+      rawToLocalNext.setFromTriplets(basisTriplets.begin(), basisTriplets.end());
+
+      //the 2x2 blocks between the local bases of the coarse and fine faces, of which the complex (rotation and scale) part is kept
+      SparseMatrix<double> localSubdivision=rawToLocalNext*G2ToRaw*decompToG2*decompSubdivision*G2ToDecomp*rawToG2*localToRaw;
+      std::vector<Triplet<Complex>> WTriplets;
+      for (int k=0;k<localSubdivision.outerSize();++k)
+        for (SparseMatrix<double>::InnerIterator it(localSubdivision,k); it; ++it){
+          int rowParity=it.row()%2, colParity=it.col()%2;
+          Complex value=(rowParity==colParity ? Complex(it.value()/2.0, 0.0) : Complex(0.0, (rowParity==1 ? 1.0 : -1.0)*it.value()/2.0));
+          WTriplets.push_back(Triplet<Complex>(it.row()/2, it.col()/2, value));
+        }
+      SparseMatrix<Complex> W(FNext.rows(), FLevel.rows());
+      W.setFromTriplets(WTriplets.begin(), WTriplets.end());
+
+      //the signed weight is the part of the block along the rotation between the bases, and coefficient n, of degree N-n, is rotated by its (N-n)th power
+      int numFCoarse=FLevel.rows(), numFFine=FNext.rows();
+      std::vector<Triplet<Complex>> PTriplets;
+      PTriplets.reserve(N*W.nonZeros());
+      for (int k=0;k<W.outerSize();++k)
+        for (SparseMatrix<Complex>::InnerIterator it(W,k); it; ++it){
+          Complex rotation(B1Level.row(it.col()).dot(B1Next.row(it.row())), B1Level.row(it.col()).dot(B2Next.row(it.row())));
+          rotation=(abs(rotation)>10e-10 ? rotation/abs(rotation) : Complex(1.0,0.0));
+          double weight=(it.value()*conj(rotation)).real();
+          if (abs(weight)<10e-10)
+            continue;
+          for (int n=0;n<N;n++)
+            PTriplets.push_back(Triplet<Complex>(n*numFFine+it.row(), n*numFCoarse+it.col(), weight*pow(rotation, N-n)));
+        }
+      data.prolongations[l].resize(N*numFFine, N*numFCoarse);
+      data.prolongations[l].setFromTriplets(PTriplets.begin(), PTriplets.end());
+
+      FLevel=FNext; EVLevel=EVNext; EFLevel=EFNext; EILevel=EINext; SFELevel=SFENext;
+      B1Level=B1Next; B2Level=B2Next;
+      numVLevel=numVNext;
+    }
+
+    //the hierarchy must reproduce the input mesh exactly
+    if ((numVLevel!=V.rows())||(FLevel.rows()!=F.rows())||(FLevel!=F))
+      return false;
+
+    data.V=V;
+    data.F=F;
+    data.EV=EVLevel;
+    data.EF=EFLevel;
+    data.B1=B1Level;
+    data.B2=B2Level;
+    polyvector_matrix(data.V, data.F, data.EV, data.EF, data.B1, data.B2, N, data.Afull, &data.M);
+    return true;
+  }
+
+
+  // Builds the multigrid hierarchy for a set of constrained faces. Must be recalculated whenever bc changes.
+  // Inputs:
+  //  bc:     The (fine) face ids where the pv is prescribed (must be nonempty).
+  //  data:   precomputed by polyvector_multigrid_precompute().
+  // Outputs:
+  //  data:   with the level systems and the factorized coarsest system.
+  IGL_INLINE void polyvector_multigrid_set_constraints(const Eigen::VectorXi& bc,
+                                                       PolyVectorMultigridData& data)
+  {
+    using namespace std;
+    using namespace Eigen;
+    typedef complex<double> Complex;
+
+    assert(bc.size()!=0);
+    const int N=data.N;
+    const int numF=data.F.rows();
+    const int numLevels=data.numLevels;
+
+    data.bc=bc;
+    data.isConstrained=VectorXi::Zero(N*numF);
+    for (int n=0;n<N;n++)
+      for (int i=0;i<bc.size();i++)
+        data.isConstrained(n*numF+bc(i))=1;
+
+    //the fine system keeps the prescribed coefficients fixed with identity rows
+    std::vector<Triplet<Complex>> ATriplets;
+    ATriplets.reserve(data.M.nonZeros());
+    for (int k=0; k<data.M.outerSize(); ++k)
+      for (SparseMatrix<Complex>::InnerIterator it(data.M,k); it; ++it)
+        if ((!data.isConstrained(it.row()))&&(!data.isConstrained(it.col())))
+          ATriplets.push_back(Triplet<Complex>(it.row(), it.col(), it.value()));
+    for (int i=0;i<N*numF;i++)
+      if (data.isConstrained(i))
+        ATriplets.push_back(Triplet<Complex>(i, i, 1.0));
+
+    data.levelMatrices.resize(numLevels+1);
+    data.levelMatrices[numLevels].resize(N*numF, N*numF);
+    data.levelMatrices[numLevels].setFromTriplets(ATriplets.begin(), ATriplets.end());
+
+    data.levelProlongations=data.prolongations;
+    if (numLevels>0){
+      const VectorXi& isConstrained=data.isConstrained;
+      data.levelProlongations[numLevels-1].prune([&](const int& row, const int&, const Complex&){return !isConstrained(row);});
+    }
+
+    for (int l=numLevels-1;l>=0;l--){
+      const SparseMatrix<Complex>& P=data.levelProlongations[l];
+      SparseMatrix<Complex> PH=P.adjoint();
+      data.levelMatrices[l]=PH*data.levelMatrices[l+1]*P;
+
+      //coarse faces whose whole patch is prescribed are decoupled
+      VectorXcd diagonal=data.levelMatrices[l].diagonal();
+      std::vector<Triplet<Complex>> decoupledTriplets;
+      for (int i=0;i<diagonal.size();i++)
+        if (abs(diagonal(i))==0.0)
+          decoupledTriplets.push_back(Triplet<Complex>(i, i, 1.0));
+      if (!decoupledTriplets.empty()){
+        SparseMatrix<Complex> decoupledMat(diagonal.size(), diagonal.size());
+        decoupledMat.setFromTriplets(decoupledTriplets.begin(), decoupledTriplets.end());
+        data.levelMatrices[l]+=decoupledMat;
+      }
+    }
+
+    data.invDiagonals.resize(numLevels+1);
+    for (int l=1;l<=numLevels;l++)
+      data.invDiagonals[l]=data.levelMatrices[l].diagonal().real().cwiseInverse();
+
+    data.coarseSolver.compute(data.levelMatrices[0]);
+    assert(data.coarseSolver.info() == Success);
+  }
+
+
+  // Applies one multigrid V-cycle from the given level as the preconditioner of the conjugate gradient.
+  IGL_INLINE void polyvector_multigrid_vcycle(const PolyVectorMultigridData& data,
+                                              const int level,
+                                              const Eigen::VectorXcd& rhs,
+                                              Eigen::VectorXcd& x)
+  {
+    using namespace Eigen;
+
+    if (level==0){
+      x=data.coarseSolver.solve(rhs);
+      return;
+    }
+
+    const SparseMatrix<std::complex<double>>& A=data.levelMatrices[level];
+    const VectorXd& invDiagonal=data.invDiagonals[level];
+
+    //pre-smoothing from a zero guess
+    x=data.jacobiWeight*invDiagonal.cwiseProduct(rhs);
+    for (int s=1;s<data.smoothingSteps;s++)
+      x+=data.jacobiWeight*invDiagonal.cwiseProduct(rhs-A*x);
+
+    //coarse correction
+    VectorXcd coarseRhs=data.levelProlongations[level-1].adjoint()*(rhs-A*x);
+    VectorXcd coarseX;
+    polyvector_multigrid_vcycle(data, level-1, coarseRhs, coarseX);
+    x+=data.levelProlongations[level-1]*coarseX;
+
+    //post-smoothing
+    for (int s=0;s<data.smoothingSteps;s++)
+      x+=data.jacobiWeight*invDiagonal.cwiseProduct(rhs-A*x);
+  }
+
+
+  // Computes a polyvector field on the fine mesh of the hierarchy from given values at the constrained faces.
+  // polyvector_multigrid_set_constraints() must be called in advance, and "b" must be on the given "bc".
+  // Inputs:
+  //  data:   precomputed hierarchy, with the constraints set.
+  //  b:      The directionals on the faces indicated by bc, in either #bc by 3N raw format or #bc by 3 representative format (implying N-RoSy)
+  // Outputs:
+  //  polyVectorField: #F by N The output interpolated field on the fine mesh, in polyvector (complex polynomial) format.
+  //                   If it is #F by N on input, it is used as the initial guess.
+  //  data:   with the iteration count and residual of the solve.
+  IGL_INLINE void polyvector_multigrid_field(PolyVectorMultigridData& data,
+                                             const Eigen::MatrixXd& b,
+                                             Eigen::MatrixXcd& polyVectorField)
+  {
+    using namespace std;
+    using namespace Eigen;
+
+    const int N=data.N;
+    const int numF=data.F.rows();
+    assert(b.rows()==data.bc.size());
+
+    MatrixXcd constValuesMat;
+    polyvector_constraint_values(data.B1, data.B2, data.bc, b, N, constValuesMat);
+
+    VectorXcd x=VectorXcd::Zero(N*numF);
+    if ((polyVectorField.rows()==numF)&&(polyVectorField.cols()==N))
+      for (int n=0;n<N;n++)
+        x.segment(n*numF, numF)=polyVectorField.col(n);
+
+    VectorXcd constValues=VectorXcd::Zero(N*numF);
+    for (int n=0;n<N;n++)
+      for (int i=0;i<data.bc.size();i++){
+        constValues(n*numF+data.bc(i))=constValuesMat(i,n);
+        x(n*numF+data.bc(i))=constValuesMat(i,n);
+      }
+
+    //the free coefficients are driven by the prescribed ones, which themselves have identity rows
+    VectorXcd rhs=-(data.M*constValues);
+    for (int i=0;i<N*numF;i++)
+      if (data.isConstrained(i))
+        rhs(i)=constValues(i);
+
+    //preconditioned conjugate gradient
+    const SparseMatrix<complex<double>>& A=data.levelMatrices[data.numLevels];
+    double rhsNorm=rhs.norm();
+    VectorXcd r=rhs-A*x;
+    VectorXcd z, p, Ap;
+    polyvector_multigrid_vcycle(data, data.numLevels, r, z);
+    p=z;
+    double rz=r.dot(z).real();
+    data.iterations=0;
+    data.residual=(rhsNorm>0.0 ? r.norm()/rhsNorm : 0.0);
+    while ((data.residual>data.tolerance)&&(data.iterations<data.maxIterations)){
+      Ap=A*p;
+      double alpha=rz/p.dot(Ap).real();
+      x+=alpha*p;
+      r-=alpha*Ap;
+      data.iterations++;
+      data.residual=r.norm()/rhsNorm;
+      if (data.residual<=data.tolerance)
+        break;
+
+      polyvector_multigrid_vcycle(data, data.numLevels, r, z);
+      double rzNew=r.dot(z).real();
+      p=z+(rzNew/rz)*p;
+      rz=rzNew;
+    }
+
+    polyVectorField.resize(numF, N);
+    for (int n=0;n<N;n++)
+      polyVectorField.col(n)=x.segment(n*numF, numF);
+  }
+
+  // Computes a power field on a mesh with subdivision connectivity with the multigrid solver, in the same representation as the version with a prefactorized solver.
+  // Inputs:
+  //  data: precomputed with polyvector_multigrid_precompute and polyvector_multigrid_set_constraints.
+  //  b: #bc by 3 in representative form of the N-RoSy's on the fine faces indicated by the constraints.
+  // Outputs:
+  //  powerField: #F by N The output interpolated field on the fine mesh, in complex numbers.
+  IGL_INLINE void power_field(PolyVectorMultigridData& data,
+                              const Eigen::MatrixXd& b,
+                              Eigen::MatrixXcd& powerField)
+  {
+    polyvector_multigrid_field(data, b, powerField);
+  }
+}
+
+#endif
@@ -9,6 +9,7 @@
 #define DIRECTIONAL_POLYVECTOR_TO_RAW_H
 
 #include <iostream>
+#include <algorithm>
 #include <igl/triangle_triangle_adjacency.h>
 #include <igl/local_basis.h>
 #include <unsupported/Eigen/Polynomials>
@@ -16,17 +17,53 @@
 #include <Eigen/Sparse>
 #include <Eigen/SparseCholesky>
 #include <Eigen/Eigenvalues>
+#include <igl/parallel_for.h>
+#include <directional/polynomial_roots.h>
 
 
 namespace directional
 {
-  // Converts a field in PolyVector representation to raw represenation.
+  // Per-face conversion with the degree fixed at compile time, which allocates nothing and writes every face straight into rawField.
+  template <int N>
+  IGL_INLINE void polyvector_to_raw(const Eigen::MatrixXd& B1,
+                                    const Eigen::MatrixXd& B2,
+                                    const Eigen::MatrixXcd& polyVectorField,
+                                    Eigen::MatrixXd& rawField,
+                                    bool signSymmetry=false)
+  {
+    const int halfN = (N>1 ? N/2 : 1);
+    rawField.resize(B1.rows(), 3 * N);
+    igl::parallel_for(B1.rows(), [&](const int f)
+    {
+      Eigen::Matrix<std::complex<double>, N, 1> roots;
+      if (!signSymmetry){
+        polynomial_roots<N, std::complex<double> >(polyVectorField.row(f).transpose(), roots);
+        std::sort(roots.data(), roots.data() + N, [](std::complex<double> a, std::complex<double> b){return arg(a) < arg(b);});
+      } else {
+        //a polynomial in z^2 of degree N/2
+        Eigen::Matrix<std::complex<double>, halfN, 1> squareCoeffs, squareRoots;
+        for (int i=0;i<N;i+=2)
+          squareCoeffs(i/2) = polyVectorField(f,i);
+        polynomial_roots<halfN, std::complex<double> >(squareCoeffs, squareRoots);
+        roots.head(halfN) = squareRoots.cwiseSqrt();
+        std::sort(roots.data(), roots.data() + halfN, [](std::complex<double> a, std::complex<double> b){return arg(a) < arg(b);});
+        roots.tail(halfN) = -roots.head(halfN);
+      }
+      
+      for (int i = 0; i < N; i++)
+        rawField.block<1, 3>(f, 3 * i) = B1.row(f) * roots(i).real() + B2.row(f) * roots(i).imag();
+    }, 1000);
+  }
+  
+  // Converts a field in PolyVector representation to raw represenation. The faces are converted in parallel, and degrees up to 8 without allocations.
   // Inputs:
   //  B1, B2:           #F by 3 matrices representing the local base of each face.
   //  polyVectorField:  #F by N complex PolyVectors
   //  N:                The degree of the field.
+  //  signSymmetry:     whether the field is made of N/2 vectors and their negations (N even, odd coefficients zero).
   // Outputs:
-  //  raw:              #F by 3*N matrix with all N explicit vectors of each directional in raw format xyzxyz
+  //  raw:              #F by 3*N matrix with all N explicit vectors of each directional in raw format xyzxyz, in counterclockwise order.
+  //                    It is reused without reallocation if it already has this size.
   IGL_INLINE void polyvector_to_raw(const Eigen::MatrixXd& B1,
                                     const Eigen::MatrixXd& B2,
                                     const Eigen::MatrixXcd& polyVectorField,
@@ -34,37 +71,38 @@ namespace directional
                                     Eigen::MatrixXd& rawField,
                                     bool signSymmetry=false)
   {
-    rawField.resize(B1.rows(), 3 * N);
+    assert((!signSymmetry)||(N%2==0));
+    switch (N){
+      case 1: polyvector_to_raw<1>(B1, B2, polyVectorField, rawField, signSymmetry); return;
+      case 2: polyvector_to_raw<2>(B1, B2, polyVectorField, rawField, signSymmetry); return;
+      case 3: polyvector_to_raw<3>(B1, B2, polyVectorField, rawField, signSymmetry); return;
+      case 4: polyvector_to_raw<4>(B1, B2, polyVectorField, rawField, signSymmetry); return;
+      case 5: polyvector_to_raw<5>(B1, B2, polyVectorField, rawField, signSymmetry); return;
+      case 6: polyvector_to_raw<6>(B1, B2, polyVectorField, rawField, signSymmetry); return;
+      case 7: polyvector_to_raw<7>(B1, B2, polyVectorField, rawField, signSymmetry); return;
+      case 8: polyvector_to_raw<8>(B1, B2, polyVectorField, rawField, signSymmetry); return;
+    }
     
-    for (int f = 0; f < B1.rows(); f++)
+    rawField.resize(B1.rows(), 3 * N);
+    igl::parallel_for(B1.rows(), [&](const int f)
     {
       Eigen::VectorXcd roots(N);
       if (!signSymmetry){
-        // Find the roots of p(t) = (t - c0)^n using
-        // https://en.wikipedia.org/wiki/Companion_matrix
-        Eigen::MatrixXcd M = Eigen::MatrixXcd::Zero(N, N);
-        for (int i = 1; i < N; ++i)
-          M(i, i - 1) = std::complex<double>(1, 0);
-        M.col(N - 1) = -polyVectorField.row(f).transpose();
-        roots = M.eigenvalues();
+        polynomial_roots(polyVectorField.row(f).transpose(), roots);
         std::sort(roots.data(), roots.data() + roots.size(), [](std::complex<double> a, std::complex<double> b){return arg(a) < arg(b);});
       } else {
-        Eigen::MatrixXcd M = Eigen::MatrixXcd::Zero(N/2, N/2);
-        for (int i = 1; i < N/2; ++i)
-          M(i, i - 1) = std::complex<double>(1, 0);
+        Eigen::VectorXcd squareCoeffs(N/2), squareRoots;
         for (int i=0;i<N;i+=2)
-          M(i/2, N/2 - 1) = -polyVectorField(f,i);
-        roots.head(N/2) = M.eigenvalues().cwiseSqrt();
+          squareCoeffs(i/2) = polyVectorField(f,i);
+        polynomial_roots(squareCoeffs, squareRoots);
+        roots.head(N/2) = squareRoots.cwiseSqrt();
         std::sort(roots.data(), roots.data() + roots.size()/2, [](std::complex<double> a, std::complex<double> b){return arg(a) < arg(b);});
         roots.tail(N/2)=-roots.head(N/2);
       }
-     
+      
       for (int i = 0; i < N; i++)
-      {
-        std::complex<double> root = roots(i);
-        rawField.block<1, 3>(f, 3 * i) = B1.row(f) * root.real() + B2.row(f) * root.imag();
-      }
-    }
+        rawField.block<1, 3>(f, 3 * i) = B1.row(f) * roots(i).real() + B2.row(f) * roots(i).imag();
+    }, 1000);
   }
   
   
@@ -16,6 +16,7 @@
 #include <igl/triangle_triangle_adjacency.h>
 #include <igl/local_basis.h>
 #include <directional/polyvector_field.h>
+#include <directional/polyvector_incremental.h>
 
 
 namespace directional
@@ -32,8 +33,9 @@ namespace directional
   //  bc: The face ids where the pv is prescribed.
   //  N: The degree of the field.
   // Outputs:
-  //  solver: with prefactorized left-hand side
+  //  solver: with prefactorized left-hand side (any solver accepted by polyvector_precompute)
   //  AFull, AVar: The resulting left-hand side matrices
+  template <class LinearSolver>
   IGL_INLINE void power_field_precompute(const Eigen::MatrixXd& V,
                                         const Eigen::MatrixXi& F,
                                         const Eigen::MatrixXi& EV,
@@ -41,7 +43,8 @@ namespace directional
                                         const Eigen::MatrixXd& B1,
                                         const Eigen::MatrixXd& B2,
                                         const Eigen::VectorXi& bc,
-                                        const int N, Eigen::SimplicialLDLT<Eigen::SparseMatrix<std::complex<double>>>& solver,
+                                        const int N,
+                                        LinearSolver& solver,
                                         Eigen::SparseMatrix<std::complex<double>>& Afull,
                                         Eigen::SparseMatrix<std::complex<double>>& AVar)
   {
@@ -60,11 +63,12 @@ namespace directional
   //  N: The degree of the field.
   // Outputs:
   //  powerField: #F by 2 The output interpolated field, in complex numbers.
+  template <class LinearSolver>
   IGL_INLINE void power_field(const Eigen::MatrixXd& B1,
                               const Eigen::MatrixXd& B2,
                               const Eigen::VectorXi& bc,
                               const Eigen::MatrixXd& b,
-                              const Eigen::SimplicialLDLT<Eigen::SparseMatrix<std::complex<double>>>& solver,
+                              const LinearSolver& solver,
                               const Eigen::SparseMatrix<std::complex<double>>& Afull,
                               const Eigen::SparseMatrix<std::complex<double>>& AVar,
                               const int N,
@@ -73,7 +77,8 @@ namespace directional
     polyvector_field(B1,B2,bc,b,solver,Afull,AVar,N,powerField);
   }
   
-  // Minimal version without auxiliary data.
+  // Minimal version without auxiliary data. The linear solver can be chosen by the template parameter.
+  template <class LinearSolver=Eigen::SimplicialLDLT<Eigen::SparseMatrix<std::complex<double>>>>
   IGL_INLINE void power_field(const Eigen::MatrixXd& V,
                               const Eigen::MatrixXi& F,
                               const Eigen::VectorXi& bc,
@@ -86,11 +91,52 @@ namespace directional
     Eigen::MatrixXd B1, B2, xd;
     igl::local_basis(V, F, B1, B2, xd);
     Eigen::SparseMatrix<std::complex<double>> Afull, AVar;
-    Eigen::SimplicialLDLT<Eigen::SparseMatrix<std::complex<double>>> solver;
+    LinearSolver solver;
     power_field_precompute(V,F,EV,EF,B1,B2,bc,N, solver,Afull,AVar);
+    powerField=-powerField;  //an initial guess is given in the positive representation as well
     power_field(B1, B2, bc, b, solver, Afull, AVar, N, powerField);
     powerField=-powerField;  //powerfield is represented positively
   }
+  
+  // Precomputation with the topology and local basis taken from a MeshContext.
+  template <class LinearSolver>
+  IGL_INLINE void power_field_precompute(const MeshContext& mesh,
+                                         const Eigen::VectorXi& bc,
+                                         const int N,
+                                         LinearSolver& solver,
+                                         Eigen::SparseMatrix<std::complex<double>>& Afull,
+                                         Eigen::SparseMatrix<std::complex<double>>& AVar)
+  {
+    polyvector_precompute(mesh, bc, N, solver, Afull, AVar);
+  }
+  
+  // Minimal version with the topology and local basis taken from a MeshContext.
+  template <class LinearSolver=Eigen::SimplicialLDLT<Eigen::SparseMatrix<std::complex<double>>>>
+  IGL_INLINE void power_field(const MeshContext& mesh,
+                              const Eigen::VectorXi& bc,
+                              const Eigen::MatrixXd& b,
+                              const int N,
+                              Eigen::MatrixXcd& powerField)
+  {
+    Eigen::SparseMatrix<std::complex<double>> Afull, AVar;
+    LinearSolver solver;
+    power_field_precompute(mesh, bc, N, solver, Afull, AVar);
+    powerField=-powerField;  //an initial guess is given in the positive representation as well
+    power_field(mesh.B1(), mesh.B2(), bc, b, solver, Afull, AVar, N, powerField);
+    powerField=-powerField;  //powerfield is represented positively
+  }
+  
+  // Computes a power field from constraints that are edited incrementally without refactorization (see polyvector_incremental.h).
+  // The constraints should be given to polyvector_incremental_set_constraint() in representative (3 columns) form.
+  // Inputs:
+  //  data: precomputed with polyvector_incremental_precompute, with the current constraints.
+  // Outputs:
+  //  powerField: #F by N The output interpolated field, in complex numbers, as in the version with a prefactorized solver.
+  IGL_INLINE void power_field(const PolyVectorIncrementalData& data,
+                              Eigen::MatrixXcd& powerField)
+  {
+    polyvector_incremental_field(data, powerField);
+  }
 }
 
 
@@ -8,7 +8,10 @@
 #ifndef DIRECTIONAL_POWER_TO_RAW_H
 #define DIRECTIONAL_POWER_TO_RAW_H
 
+#include <Eigen/Geometry>
 #include <igl/local_basis.h>
+#include <igl/parallel_for.h>
+#include <igl/PI.h>
 #include <directional/rotation_to_representative.h>
 #include <directional/representative_to_raw.h>
 #include <directional/power_to_representative.h>
@@ -16,13 +19,15 @@
 namespace directional
 {
   // Converts the power complex representation to raw representation.
+  // The faces are converted in parallel, straight into rawField, by rotating the principal root of each power vector.
   // Input:
-  //  B1, B2, B3: bases for each face from igl::local_base().
+  //  B1, B2, B3: bases for each face from igl::local_base(). B3 is the normal around which the vectors are ordered, and may have either orientation with respect to B1 x B2.
   //  powerField: #F x 1 Representation of the field as complex numbers
   //  N: the degree of the field.
   // normalize: whether to produce a normalized result (length = 1)
   // Output:
-  //  rawField: #F by 3*N matrix with all N explicit vectors of each directional in the order X,Y,Z,X,Y,Z, ...
+  //  rawField: #F by 3*N matrix with all N explicit vectors of each directional in the order X,Y,Z,X,Y,Z, ..., in counterclockwise order around B3.
+  //            It is reused without reallocation if it already has this size.
   IGL_INLINE void power_to_raw(const Eigen::MatrixXd& B1,
                                const Eigen::MatrixXd& B2,
                                const Eigen::MatrixXd& B3,
@@ -31,11 +36,19 @@ namespace directional
                                Eigen::MatrixXd& rawField,
                                bool normalize=false)
   {
-    Eigen::MatrixXd representative;
-    power_to_representative(B1, B2, powerField, N, representative);
-    if (normalize)
-      representative.rowwise().normalize();
-    representative_to_raw(B3, representative, N, rawField);
+    rawField.resize(B1.rows(), 3 * N);
+    //a counterclockwise rotation about B3 is a complex rotation in the (B1,B2) plane, whose direction depends on the handedness of the frame
+    const std::complex<double> rotation = std::polar(1.0, 2.0*igl::PI/(double)N);
+    igl::parallel_for(B1.rows(), [&](const int f)
+    {
+      Eigen::RowVector3d b1 = B1.row(f), b2 = B2.row(f), b3 = B3.row(f);
+      const std::complex<double> faceRotation = (b1.cross(b2).dot(b3) >= 0.0 ? rotation : std::conj(rotation));
+      std::complex<double> root = std::pow(powerField(f, 0), 1.0/(double)N);
+      if ((normalize)&&(std::abs(root)>0.0))
+        root/=std::abs(root);
+      for (int i = 0; i < N; i++, root*=faceRotation)
+        rawField.block<1, 3>(f, 3 * i) = B1.row(f) * root.real() + B2.row(f) * root.imag();
+    }, 1000);
   }
   
   // version without auxiliary data
@@ -13,6 +13,7 @@
 #include <Eigen/SparseCholesky>
 #include <Eigen/Eigenvalues>
 #include <igl/local_basis.h>
+#include <igl/parallel_for.h>
 #include <iostream>
 
 namespace directional
@@ -32,17 +33,12 @@ namespace directional
   {
     // Convert the interpolated polyvector into Euclidean vectors
     representativeField.conservativeResize(B1.rows(), 3);
-    for (int f = 0; f < B1.rows(); ++f)
+    igl::parallel_for(B1.rows(), [&](const int f)
     {
-      // Find the roots of p(t) = (t - c0)^n using
-      // https://en.wikipedia.org/wiki/Companion_matrix
-      Eigen::MatrixXcd M = Eigen::MatrixXcd::Zero(N, N);
-      for (int i = 1; i < N; ++i)
-        M(i, i - 1) = std::complex<double>(1, 0);
-      M(0, N - 1) = powerField(f, 0);
-      std::complex<double> root = M.eigenvalues()(0);
+      // The principal root of t^N = powerField(f)
+      std::complex<double> root = std::pow(powerField(f, 0), 1.0/(double)N);
       representativeField.row(f) = B1.row(f) * root.real() + B2.row(f) * root.imag();
-    }
+    }, 1000);
   }
   
   
@@ -14,7 +14,9 @@
 #include <igl/gaussian_curvature.h>
 #include <igl/local_basis.h>
 #include <igl/edge_topology.h>
+#include <igl/parallel_for.h>
 #include <directional/representative_to_raw.h>
+#include <directional/MeshContext.h>
 
 namespace directional
 {
@@ -22,18 +24,18 @@ namespace directional
   // Important: if the Raw field in not CCW ordered, the result is meaningless.
   // Input:
   //  V:      #V x 3 vertex coordinates
-  //  F:      #F x 3 face vertex indices
   //  EV:     #E x 2 edges to vertices indices
   //  EF:     #E x 2 edges to faces indices
+  //  B1, B2: #F x 3 local basis of each face (as in igl::local_basis)
   //  raw:    The directional field, assumed to be ordered CCW, and in xyzxyzxyz...xyz (3*N cols) form. The degree is inferred by the size.
   // Output:
   //  matching: #E matching function, where vector k in EF(i,0) matches to vector (k+matching(k))%N in EF(i,1). In case of boundary, there is a -1.
   //= effort: #E principal matching efforts.
   IGL_INLINE void principal_matching(const Eigen::MatrixXd& V,
-                                     const Eigen::MatrixXi& F,
                                      const Eigen::MatrixXi& EV,
                                      const Eigen::MatrixXi& EF,
-                                     const Eigen::MatrixXi& FE,
+                                     const Eigen::MatrixXd& B1,
+                                     const Eigen::MatrixXd& B2,
                                      const Eigen::MatrixXd& rawField,
                                      Eigen::VectorXi& matching,
                                      Eigen::VectorXd& effort)
@@ -43,56 +45,48 @@ namespace directional
     using namespace Eigen;
     using namespace std;
     
-    MatrixXd B1, B2, B3;
-    igl::local_basis(V, F, B1, B2, B3);
-    
     int N = rawField.cols() / 3;
     
     matching.conservativeResize(EF.rows());
     matching.setConstant(-1);
+    effort = VectorXd::Zero(EF.rows());
     
-    VectorXcd edgeTransport(EF.rows());  //the difference in the angle representation of edge i from EF(i,0) to EF(i,1)
-    MatrixXd edgeVectors(EF.rows(), 3);
-    for (int i = 0; i < EF.rows(); i++) {
-      if (EF(i, 0) == -1 || EF(i, 1) == -1)
-        continue;
-      edgeVectors.row(i) = (V.row(EV(i, 1)) - V.row(EV(i, 0))).normalized();
-      Complex ef(edgeVectors.row(i).dot(B1.row(EF(i, 0))), edgeVectors.row(i).dot(B2.row(EF(i, 0))));
-      Complex eg(edgeVectors.row(i).dot(B1.row(EF(i, 1))), edgeVectors.row(i).dot(B2.row(EF(i, 1))));
-      edgeTransport(i) = eg / ef;
+    //the complex representation of every vector in the basis of its face, computed once per face instead of per adjacent edge.
+    MatrixXcd faceField(rawField.rows(), N);
+    for (int j = 0; j < N; j++) {
+      faceField.col(j).real() = rawField.col(3 * j).array() * B1.col(0).array() + rawField.col(3 * j + 1).array() * B1.col(1).array() + rawField.col(3 * j + 2).array() * B1.col(2).array();
+      faceField.col(j).imag() = rawField.col(3 * j).array() * B2.col(0).array() + rawField.col(3 * j + 1).array() * B2.col(1).array() + rawField.col(3 * j + 2).array() * B2.col(2).array();
     }
     
-    effort = VectorXd::Zero(EF.rows());
-    for (int i = 0; i < EF.rows(); i++) {
+    //edges are independent, and each writes only its own matching and effort, so the result does not depend on the number of threads.
+    igl::parallel_for(EF.rows(), [&](const int i)
+    {
       if (EF(i, 0) == -1 || EF(i, 1) == -1)
-        continue;
+        return;
+      
+      //the difference in the angle representation of edge i from EF(i,0) to EF(i,1)
+      RowVector3d edgeVector = (V.row(EV(i, 1)) - V.row(EV(i, 0))).normalized();
+      Complex ef(edgeVector.dot(B1.row(EF(i, 0))), edgeVector.dot(B2.row(EF(i, 0))));
+      Complex eg(edgeVector.dot(B1.row(EF(i, 1))), edgeVector.dot(B2.row(EF(i, 1))));
+      Complex edgeTransport = eg / ef;
+      
       //computing free coefficient effort (a.k.a. [Diamanti et al. 2014])
-      //Complex freeCoeffEffort(1.0, 0.0);
       double minRotAngle=10000.0;
       int indexMinFromZero=0;
       
       //computing some effort and the extracting principal one
       Complex freeCoeff(1.0,0.0);
       //finding where the 0 vector in EF(i,0) goes to with smallest rotation angle in EF(i,1), computing the effort, and then adjusting the matching to have principal effort.
-      
-      RowVector3d vec0f = rawField.block(EF(i, 0), 0, 1, 3);
-      Complex vec0fc = Complex(vec0f.dot(B1.row(EF(i, 0))), vec0f.dot(B2.row(EF(i, 0))));
-      Complex transvec0fc = vec0fc*edgeTransport(i);
+      Complex transvec0fc = faceField(EF(i, 0), 0)*edgeTransport;
       for (int j = 0; j < N; j++) {
-        RowVector3d vecjf = rawField.block(EF(i, 0), 3 * j, 1, 3);
-        Complex vecjfc = Complex(vecjf.dot(B1.row(EF(i, 0))), vecjf.dot(B2.row(EF(i, 0))));
-        RowVector3d vecjg = rawField.block(EF(i, 1), 3 * j, 1, 3);
-        Complex vecjgc = Complex(vecjg.dot(B1.row(EF(i, 1))), vecjg.dot(B2.row(EF(i, 1))));
-        Complex transvecjfc = vecjfc*edgeTransport(i);
+        Complex transvecjfc = faceField(EF(i, 0), j)*edgeTransport;
+        Complex vecjgc = faceField(EF(i, 1), j);
         freeCoeff *= (vecjgc / transvecjfc);
         double currRotAngle =arg(vecjgc / transvec0fc);
         if (abs(currRotAngle)<abs(minRotAngle)){
           indexMinFromZero=j;
           minRotAngle=currRotAngle;
         }
-        
-        //taking principal effort
-        
       }
       effort(i) = arg(freeCoeff);
       
@@ -100,19 +94,37 @@ namespace directional
       //This is still not perfect
       double currEffort=0;
       for (int j = 0; j < N; j++) {
-        RowVector3d vecjf = rawField.block(EF(i, 0), 3*j, 1, 3);
-        Complex vecjfc = Complex(vecjf.dot(B1.row(EF(i, 0))), vecjf.dot(B2.row(EF(i, 0))));
-        RowVector3d vecjg = rawField.block(EF(i, 1), 3 *((j+indexMinFromZero+N)%N), 1, 3);
-        Complex vecjgc = Complex(vecjg.dot(B1.row(EF(i, 1))), vecjg.dot(B2.row(EF(i, 1))));
-        Complex transvecjfc = vecjfc*edgeTransport(i);
+        Complex transvecjfc = faceField(EF(i, 0), j)*edgeTransport;
+        Complex vecjgc = faceField(EF(i, 1), (j+indexMinFromZero+N)%N);
         currEffort+= arg(vecjgc / transvecjfc);
       }
-   
-      matching(i)=indexMinFromZero-round((currEffort-effort(i))/(2.0*igl::PI));
-      //effort(i)=currEffort+2*igl::PI*(double)(indexMinFromZero-matching(i));
       
-    }
-    
+      matching(i)=indexMinFromZero-round((currEffort-effort(i))/(2.0*igl::PI));
+    }, 1000);
+  }
+  
+  //Version that computes the local basis from (V,F).
+  IGL_INLINE void principal_matching(const Eigen::MatrixXd& V,
+                                     const Eigen::MatrixXi& F,
+                                     const Eigen::MatrixXi& EV,
+                                     const Eigen::MatrixXi& EF,
+                                     const Eigen::MatrixXi& FE,
+                                     const Eigen::MatrixXd& rawField,
+                                     Eigen::VectorXi& matching,
+                                     Eigen::VectorXd& effort)
+  {
+    Eigen::MatrixXd B1, B2, B3;
+    igl::local_basis(V, F, B1, B2, B3);
+    principal_matching(V, EV, EF, B1, B2, rawField, matching, effort);
+  }
+  
+  //Version with the topology and local basis taken from a MeshContext.
+  IGL_INLINE void principal_matching(const MeshContext& mesh,
+                                     const Eigen::MatrixXd& rawField,
+                                     Eigen::VectorXi& matching,
+                                     Eigen::VectorXd& effort)
+  {
+    principal_matching(mesh.V, mesh.EV(), mesh.EF(), mesh.B1(), mesh.B2(), rawField, matching, effort);
   }
   
   //Version with representative vector (for N-RoSy alone) as input.
@@ -130,6 +142,18 @@ namespace directional
     representative_to_raw(V, F, representativeField, N, rawField);
     principal_matching(V, F, EV, EF, FE, rawField, matching, effort);
   }
+  
+  //Version with representative vector (for N-RoSy alone) and a MeshContext as input.
+  IGL_INLINE void principal_matching(const MeshContext& mesh,
+                                     const Eigen::MatrixXd& representativeField,
+                                     const int N,
+                                     Eigen::VectorXi& matching,
+                                     Eigen::VectorXd& effort)
+  {
+    Eigen::MatrixXd rawField;
+    representative_to_raw(mesh.FN(), representativeField, N, rawField);
+    principal_matching(mesh, rawField, matching, effort);
+  }
 }
 
 
@@ -0,0 +1,161 @@
+// This file is part of Directional, a library for directional field processing.
+// Copyright (C) 2018 Amir Vaxman <avaxman@gmail.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef DIRECTIONAL_READ_BINARY_RAW_FIELD_H
+#define DIRECTIONAL_READ_BINARY_RAW_FIELD_H
+#include <cstdint>
+#include <cstring>
+#include <Eigen/Core>
+#include <string>
+#include <fstream>
+#include <igl/igl_inline.h>
+
+
+namespace directional
+{
+  // The binary raw field format (little endian):
+  //   a 64-byte BinaryRawFieldHeader,
+  //   the field: #F by 3*N values in row-major xyzxyz order (double or float according to dtype), starting at dataOffset,
+  //   the matching: numMatching int32 values (optional),
+  //   the singularities: numSingularities int32 vertices followed by numSingularities int32 indices (optional).
+  // The field starts at a 64-byte aligned offset, so that a memory-mapped file can be wrapped directly by an Eigen::Map (see MappedRawField).
+  // The values are read and written in the byte order of the host, so the format is only supported on little-endian hosts.
+  const std::int32_t BINARY_RAW_FIELD_VERSION = 1;
+  const std::int32_t BINARY_RAW_FIELD_MAX_N = 1 << 16;  //keeps the 3*N*scalar byte size of a face in int range
+  enum BinaryRawFieldType {BINARY_RAW_FIELD_DOUBLE = 0, BINARY_RAW_FIELD_FLOAT = 1};
+  
+  inline bool binary_raw_field_host_supported()
+  {
+    const std::uint16_t probe = 1;
+    unsigned char firstByte;
+    std::memcpy(&firstByte, &probe, 1);
+    return (firstByte == 1);
+  }
+  
+  struct BinaryRawFieldHeader
+  {
+    char magic[4];                    // "DRFB"
+    std::int32_t version;             // BINARY_RAW_FIELD_VERSION
+    std::int32_t N;                   // degree of the field
+    std::int32_t dtype;               // BinaryRawFieldType
+    std::int64_t numF;                // number of faces
+    std::int64_t numMatching;         // #E if a matching is stored, 0 otherwise
+    std::int64_t numSingularities;    // number of stored singularities
+    std::int64_t dataOffset;          // byte offset of the field
+    char reserved[16];
+    
+    // byte size of each field value
+    std::int64_t scalar_size() const {return (dtype == BINARY_RAW_FIELD_FLOAT ? sizeof(float) : sizeof(double));}
+    // byte offsets of the optional sections
+    std::int64_t matching_offset() const {return dataOffset + numF * 3 * N * scalar_size();}
+    std::int64_t singularities_offset() const {return matching_offset() + numMatching * sizeof(std::int32_t);}
+    std::int64_t file_size() const {return singularities_offset() + 2 * numSingularities * sizeof(std::int32_t);}
+    
+    // whether the header was written in the other byte order
+    bool is_byte_swapped() const
+    {
+      unsigned char versionBytes[4];
+      std::memcpy(versionBytes, &version, 4);
+      return ((versionBytes[0] == 0) && (versionBytes[3] == BINARY_RAW_FIELD_VERSION) && binary_raw_field_host_supported());
+    }
+    
+    // whether the sections fit in a file of the given byte length, without overflowing the offsets
+    bool fits_in(const std::int64_t fileLength) const
+    {
+      if (fileLength < dataOffset)
+        return false;
+      std::int64_t available = fileLength - dataOffset;
+      if (numF > available / (3 * N * scalar_size()))
+        return false;
+      available -= numF * 3 * N * scalar_size();
+      if (numMatching > available / (std::int64_t)sizeof(std::int32_t))
+        return false;
+      available -= numMatching * sizeof(std::int32_t);
+      return (numSingularities <= available / (2 * (std::int64_t)sizeof(std::int32_t)));
+    }
+    
+    bool is_valid() const
+    {
+      return (binary_raw_field_host_supported() && (std::strncmp(magic, "DRFB", 4) == 0) && (version == BINARY_RAW_FIELD_VERSION) &&
+              (N > 0) && (N <= BINARY_RAW_FIELD_MAX_N) && (numF >= 0) &&
+              ((dtype == BINARY_RAW_FIELD_DOUBLE) || (dtype == BINARY_RAW_FIELD_FLOAT)) &&
+              (numMatching >= 0) && (numSingularities >= 0) && (dataOffset >= (std::int64_t)sizeof(BinaryRawFieldHeader)));
+    }
+  };
+  static_assert(sizeof(BinaryRawFieldHeader) == 64, "The binary raw field header must be 64 bytes");
+  
+  
+  // Reads a raw field from a file in binary format, with its matching and singularities if they are stored.
+  // Inputs:
+  //   fileName: The to be loaded file.
+  // Outputs:
+  //   N:            The degree of the field
+  //   rawField:     the read field in raw #F by 3*N xyzxyz format
+  //   matching:     #E matching, or empty if not stored
+  //   singVertices: The singular vertices, or empty if not stored
+  //   singIndices:  The index of the singularities, where the actual fractional index is singIndices/N.
+  // Return:
+  //   Whether or not the file was read successfully
+  bool IGL_INLINE read_binary_raw_field(const std::string &fileName,
+                                        int& N,
+                                        Eigen::MatrixXd& rawField,
+                                        Eigen::VectorXi& matching,
+                                        Eigen::VectorXi& singVertices,
+                                        Eigen::VectorXi& singIndices)
+  {
+    typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> RowMatrixXd;
+    typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> RowMatrixXf;
+    typedef Eigen::Matrix<std::int32_t, Eigen::Dynamic, 1> VectorXi32;
+    
+    std::ifstream f(fileName, std::ios::binary | std::ios::ate);
+    if (!f.is_open())
+      return false;
+    std::int64_t fileLength = f.tellg();
+    f.seekg(0);
+    
+    //the sizes in the header are checked against the file before anything is allocated
+    BinaryRawFieldHeader header;
+    if (!f.read(reinterpret_cast<char*>(&header), sizeof(header)) || !header.is_valid() || !header.fits_in(fileLength))
+      return false;
+    
+    N = header.N;
+    f.seekg(header.dataOffset);
+    //the file is row major, as the text format
+    if (header.dtype == BINARY_RAW_FIELD_DOUBLE){
+      RowMatrixXd rowField(header.numF, 3 * N);
+      f.read(reinterpret_cast<char*>(rowField.data()), rowField.size() * sizeof(double));
+      rawField = rowField;
+    } else {
+      RowMatrixXf rowField(header.numF, 3 * N);
+      f.read(reinterpret_cast<char*>(rowField.data()), rowField.size() * sizeof(float));
+      rawField = rowField.cast<double>();
+    }
+    
+    VectorXi32 buffer(header.numMatching);
+    f.read(reinterpret_cast<char*>(buffer.data()), buffer.size() * sizeof(std::int32_t));
+    matching = buffer.cast<int>();
+    
+    buffer.resize(header.numSingularities);
+    f.read(reinterpret_cast<char*>(buffer.data()), buffer.size() * sizeof(std::int32_t));
+    singVertices = buffer.cast<int>();
+    f.read(reinterpret_cast<char*>(buffer.data()), buffer.size() * sizeof(std::int32_t));
+    singIndices = buffer.cast<int>();
+    
+    return !f.fail();
+  }
+  
+  
+  // Reads only the raw field from a file in binary format
+  bool IGL_INLINE read_binary_raw_field(const std::string &fileName,
+                                        int& N,
+                                        Eigen::MatrixXd& rawField)
+  {
+    Eigen::VectorXi matching, singVertices, singIndices;
+    return read_binary_raw_field(fileName, N, rawField, matching, singVertices, singIndices);
+  }
+}
+
+#endif
@@ -0,0 +1,45 @@
+// This file is part of Directional, a library for directional field processing.
+// Copyright (C) 2018 Amir Vaxman <avaxman@gmail.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef DIRECTIONAL_READ_RAW_FIELD_CHUNKED_H
+#define DIRECTIONAL_READ_RAW_FIELD_CHUNKED_H
+
+#include <string>
+#include <functional>
+#include <Eigen/Core>
+#include <igl/igl_inline.h>
+#include <directional/RawFieldStreamReader.h>
+
+namespace directional
+{
+  // Reads a raw field file (text or binary format) in blocks of faces and passes each block to a callback, so that per-face
+  // operations run in memory bounded by the block size, regardless of the size of the file.
+  // Inputs:
+  //   fileName:  The to be loaded file.
+  //   blockSize: The maximal number of faces in a block.
+  //   callback:  called with (N, firstFace, block) for every block in order, where block is #B by 3*N in xyzxyz format.
+  //              Returning false stops the reading.
+  // Return:
+  //   Whether or not the file was read successfully (a stop requested by the callback is not a failure)
+  bool IGL_INLINE read_raw_field_chunked(const std::string &fileName,
+                                         const int blockSize,
+                                         const std::function<bool(const int, const Eigen::Index, const Eigen::MatrixXd&)>& callback)
+  {
+    RawFieldStreamReader reader;
+    if (!reader.open(fileName))
+      return false;
+    
+    Eigen::MatrixXd block;
+    Eigen::Index firstFace;
+    while (reader.next(blockSize, block, firstFace))
+      if (!callback(reader.get_N(), firstFace, block))
+        return true;
+    
+    return (firstFace==reader.num_faces());
+  }
+}
+
+#endif
@@ -0,0 +1,109 @@
+// This file is part of Directional, a library for directional field processing.
+// Copyright (C) 2018 Amir Vaxman <avaxman@gmail.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef DIRECTIONAL_SAMPLE_FACES_H
+#define DIRECTIONAL_SAMPLE_FACES_H
+
+#include <vector>
+#include <Eigen/Core>
+#include <igl/igl_inline.h>
+
+namespace directional
+{
+  // Greedily samples faces so that no two samples are within ringDistance face rings of each other, and every face is within ringDistance rings of a sample.
+  // Faces are visited in order, and each sample masks its ring neighborhood by a breadth-first search that stops at ringDistance, so the cost is linear in #F.
+  // Inputs:
+  //  F:            #F by 3 face vertex indices.
+  //  EF:           #E by 2 matrix of oriented adjacent faces
+  //  ringDistance: the minimal distance between samples, in face rings. 0 samples every face.
+  // Outputs:
+  //  samples:      #S sampled face indices, in increasing order.
+  //  clusters:     #F index into samples of the sample closest (in face rings) to each face.
+  IGL_INLINE void sample_faces(const Eigen::MatrixXi& F,
+                               const Eigen::MatrixXi& EF,
+                               const int ringDistance,
+                               Eigen::VectorXi& samples,
+                               Eigen::VectorXi& clusters)
+  {
+    //face adjacency in compressed rows
+    std::vector<int> adjStart(F.rows()+1,0);
+    for (int i=0;i<EF.rows();i++)
+      if ((EF(i,0)!=-1)&&(EF(i,1)!=-1)){
+        adjStart[EF(i,0)+1]++;
+        adjStart[EF(i,1)+1]++;
+      }
+    for (int i=0;i<F.rows();i++)
+      adjStart[i+1]+=adjStart[i];
+    std::vector<int> adjFaces(adjStart[F.rows()]);
+    std::vector<int> adjFill(adjStart.begin(), adjStart.end()-1);
+    for (int i=0;i<EF.rows();i++)
+      if ((EF(i,0)!=-1)&&(EF(i,1)!=-1)){
+        adjFaces[adjFill[EF(i,0)]++]=EF(i,1);
+        adjFaces[adjFill[EF(i,1)]++]=EF(i,0);
+      }
+
+    //the greedy sampling; a face is visited by the search of a sample if lastVisit holds that sample
+    Eigen::VectorXi sampleMask=Eigen::VectorXi::Zero(F.rows());
+    std::vector<int> lastVisit(F.rows(),-1), depth(F.rows(),0), front;
+    std::vector<int> samplesList;
+    for (int i=0;i<F.rows();i++){
+      if (sampleMask(i)!=0) //occupied face
+        continue;
+
+      sampleMask(i)=2;
+      samplesList.push_back(i);
+      front.assign(1,i);
+      lastVisit[i]=i;
+      depth[i]=0;
+      for (int j=0;j<(int)front.size();j++){
+        int f=front[j];
+        if (depth[f]==ringDistance)
+          continue;
+        for (int k=adjStart[f];k<adjStart[f+1];k++){
+          int g=adjFaces[k];
+          if (lastVisit[g]==i)
+            continue;
+          lastVisit[g]=i;
+          depth[g]=depth[f]+1;
+          front.push_back(g);
+          if (sampleMask(g)==0)
+            sampleMask(g)=1;
+        }
+      }
+    }
+
+    samples = Eigen::Map<Eigen::VectorXi, Eigen::Unaligned>(samplesList.data(), samplesList.size());
+
+    //assigning each face to its closest sample by a search from all samples at once
+    clusters=Eigen::VectorXi::Constant(F.rows(),-1);
+    front.clear();
+    for (int i=0;i<samples.size();i++){
+      clusters(samples(i))=i;
+      front.push_back(samples(i));
+    }
+    for (int j=0;j<(int)front.size();j++){
+      int f=front[j];
+      for (int k=adjStart[f];k<adjStart[f+1];k++)
+        if (clusters(adjFaces[k])==-1){
+          clusters(adjFaces[k])=clusters(f);
+          front.push_back(adjFaces[k]);
+        }
+    }
+  }
+
+  // Version without the clusters.
+  IGL_INLINE void sample_faces(const Eigen::MatrixXi& F,
+                               const Eigen::MatrixXi& EF,
+                               const int ringDistance,
+                               Eigen::VectorXi& samples)
+  {
+    Eigen::VectorXi clusters;
+    sample_faces(F, EF, ringDistance, samples, clusters);
+  }
+}
+
+#endif
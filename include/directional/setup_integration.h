@@ -61,8 +61,10 @@ namespace directional
     bool roundSeams;        //Whether to round seams or round singularities
     bool verbose;           //output the integration log.
     bool localInjectivity;  //Enforce local injectivity; might result in failure!
+    bool blockRounding;     //Round all variables within roundingTolerance of an integer per solve, rather than one per solve, in the iterative rounding of integrate().
+    double roundingTolerance;  //distance from an integer under which variables are rounded together in block rounding
     
-    IntegrationData(int _N):lengthRatio(0.02), integralSeamless(false), roundSeams(true), verbose(false), localInjectivity(false){
+    IntegrationData(int _N):lengthRatio(0.02), integralSeamless(false), roundSeams(true), verbose(false), localInjectivity(false), blockRounding(false), roundingTolerance(0.1){
       N=_N;
       n=(N%2==0 ? N/2 : N);
       if (N%2==0)
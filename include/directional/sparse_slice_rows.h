@@ -0,0 +1,45 @@
+// This file is part of Directional, a library for directional field processing.
+// Copyright (C) 2021 Amir Vaxman <avaxman@gmail.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef DIRECTIONAL_SPARSE_SLICE_ROWS_H
+#define DIRECTIONAL_SPARSE_SLICE_ROWS_H
+
+#include <vector>
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+#include <igl/igl_inline.h>
+
+namespace directional
+{
+  // Extracts a subset of the rows of a sparse matrix, in the given order, in time linear in the nonzeros (through the inverse map of the rows), e.g. to apply a (partial) row permutation.
+  // Inputs:
+  //  A:      #r by #c sparse matrix.
+  //  rows:   #s distinct row indices into A.
+  // Outputs:
+  //  result: #s by #c matrix where result.row(i)=A.row(rows(i)).
+  template <typename Scalar>
+  IGL_INLINE void sparse_slice_rows(const Eigen::SparseMatrix<Scalar>& A,
+                                    const Eigen::VectorXi& rows,
+                                    Eigen::SparseMatrix<Scalar>& result)
+  {
+    Eigen::VectorXi inverseRows=Eigen::VectorXi::Constant(A.rows(),-1);
+    for (int i=0;i<rows.size();i++)
+      inverseRows(rows(i))=i;
+
+    std::vector<Eigen::Triplet<Scalar> > resultTriplets;
+    resultTriplets.reserve(A.nonZeros());
+    for (int k=0; k<A.outerSize(); ++k)
+      for (typename Eigen::SparseMatrix<Scalar>::InnerIterator it(A,k); it; ++it)
+        if (inverseRows(it.row())!=-1)
+          resultTriplets.push_back(Eigen::Triplet<Scalar>(inverseRows(it.row()), it.col(), it.value()));
+
+    result.resize(rows.size(), A.cols());
+    result.setFromTriplets(resultTriplets.begin(), resultTriplets.end());
+  }
+}
+
+#endif
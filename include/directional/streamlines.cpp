@@ -7,76 +7,111 @@
 // obtain one at http://mozilla.org/MPL/2.0/.
 
 #include <Eigen/Geometry>
+#include <limits>
 #include <igl/edge_topology.h>
 #include <igl/sort_vectors_ccw.h>
 #include <igl/per_face_normals.h>
-#include <igl/segment_segment_intersect.h>
+#include <igl/parallel_for.h>
 #include <igl/triangle_triangle_adjacency.h>
 #include <igl/barycenter.h>
 #include <igl/slice.h>
-#include <igl/speye.h>
+#include <directional/sample_faces.h>
 #include <directional/principal_matching.h>
+#include <directional/effort_to_indices.h>
 #include <directional/streamlines.h>
 
 
 namespace Directional {
-IGL_INLINE void generate_sample_locations(const Eigen::MatrixXi& F,
-                                                       const Eigen::MatrixXi& EF,
-                                                       const int ringDistance,
-                                                       Eigen::VectorXi& samples)
+// Finds where the ray p+t*r leaves face f. In barycentric coordinates the ray is linear, and it leaves through the edge whose opposite coordinate vanishes first.
+// Returns the local index k of the exit edge (F(f,k) -> F(f,(k+1)%3)) and its parameter t, or -1 if the ray does not leave the face.
+IGL_INLINE int streamline_exit_edge(const Eigen::MatrixXd& V,
+                                    const Eigen::MatrixXi& F,
+                                    const int f,
+                                    const Eigen::RowVector3d& p,
+                                    const Eigen::RowVector3d& r,
+                                    double& t)
 {
-  //creating adjacency matrix
-  std::vector<Eigen::Triplet<int>> adjTris;
-  for (int i=0;i<EF.rows();i++)
-    if ((EF(i,0)!=-1)&&(EF(i,1)!=-1)){
-      adjTris.push_back(Eigen::Triplet<int>(EF(i,0), EF(i,1),1));
-      adjTris.push_back(Eigen::Triplet<int>(EF(i,1), EF(i,0),1));
-    }
-  
-  Eigen::SparseMatrix<int> adjMat(F.rows(),F.rows());
-  adjMat.setFromTriplets(adjTris.begin(), adjTris.end());
-  Eigen::SparseMatrix<int> newAdjMat(F.rows(),F.rows()),matMult;
-  igl::speye(F.rows(), F.rows(), matMult);
-  for (int i=0;i<ringDistance;i++){
-    matMult=matMult*adjMat;
-    newAdjMat+=matMult;
-  }
-  
-  //cout<<"newAdjMat: "<<newAdjMat<<endl;
+  const Eigen::RowVector3d a = V.row(F(f,0));
+  const Eigen::RowVector3d e1 = V.row(F(f,1)) - a;
+  const Eigen::RowVector3d e2 = V.row(F(f,2)) - a;
+  const double e11 = e1.dot(e1), e12 = e1.dot(e2), e22 = e2.dot(e2);
+  const double det = e11 * e22 - e12 * e12;
+  if (det <= 0.0)
+    return -1;
   
-  adjMat=newAdjMat;
+  const Eigen::RowVector3d pa = p - a;
+  const double p1 = pa.dot(e1), p2 = pa.dot(e2), r1 = r.dot(e1), r2 = r.dot(e2);
+  Eigen::Vector3d lambda, dLambda;
+  lambda(1) = (e22 * p1 - e12 * p2) / det;
+  lambda(2) = (e11 * p2 - e12 * p1) / det;
+  lambda(0) = 1.0 - lambda(1) - lambda(2);
+  dLambda(1) = (e22 * r1 - e12 * r2) / det;
+  dLambda(2) = (e11 * r2 - e12 * r1) / det;
+  dLambda(0) = -dLambda(1) - dLambda(2);
   
-  std::vector<std::set<int>> ringAdjacencies(F.rows());
-  for (int k=0; k<adjMat.outerSize(); ++k){
-    for (Eigen::SparseMatrix<int>::InnerIterator it(adjMat,k); it; ++it){
-      ringAdjacencies[it.row()].insert(it.col());
-      ringAdjacencies[it.col()].insert(it.row());
-    }
-  }
-
-  Eigen::VectorXi sampleMask=Eigen::VectorXi::Zero(F.rows());
-  for (int i=0;i<F.rows();i++){
-    if (sampleMask(i)!=0) //occupied face
+  int exitEdge = -1;
+  t = std::numeric_limits<double>::max();
+  for (int j = 0; j < 3; ++j){
+    if (dLambda(j) >= 0.0)
       continue;
-    
-    sampleMask(i)=2;
-    //clearing out all other faces
-    //cout<<"closeby set to face "<<i<<endl;
-    for (std::set<int>::iterator si=ringAdjacencies[i].begin();si!=ringAdjacencies[i].end();si++){
-      if (sampleMask(*si)==0)
-        sampleMask(*si)=1;
-      //cout<<*si<<" ";
+    double tj = std::max(lambda(j), 0.0) / (-dLambda(j));
+    if (tj < t){
+      t = tj;
+      exitEdge = (j + 1) % 3;  //the edge opposite to vertex j
     }
-    //cout<<endl;
-    
   }
+  return exitEdge;
+}
+
+// Advances a single line to the edge through which it leaves its face, and moves it to the matched direction on the next face (-1 on the boundary).
+// Returns false (and leaves the line untouched) if it cannot leave the face.
+IGL_INLINE bool streamline_step(const Eigen::MatrixXd& V,
+                                const Eigen::MatrixXi& F,
+                                const directional::StreamlineData& data,
+                                int& face,
+                                int& direction,
+                                Eigen::RowVector3d& point)
+{
+  const Eigen::RowVector3d r = data.field.block(face, 3 * direction, 1, 3);
+  double t;
+  int k = streamline_exit_edge(V, F, face, point, r, t);
+  if (k == -1)
+    return false;
   
-  std::vector<int> samplesList;
-  for (int i=0;i<sampleMask.size();i++)
-    if (sampleMask(i)==2)
-      samplesList.push_back(i);
+  point += t * r;
   
-  samples = Eigen::Map<Eigen::VectorXi, Eigen::Unaligned>(samplesList.data(), samplesList.size());
+  // matching direction on next face
+  int e1 = data.FE(face, k);
+  if (data.EF(e1, 0) == face)
+    direction = (data.matching(e1) + direction) % data.degree;
+  else
+    direction = (-data.matching(e1) + direction + data.degree) % data.degree;
+  face = data.TT(face, k);
+  return true;
+}
+
+// Computes the faces adjacent to singular vertices, where the traced lines stop, unless they are already set.
+// Without the matching effort (data not created by streamlines_init) no face is singular.
+IGL_INLINE void streamline_singular_faces(const Eigen::MatrixXd& V,
+                                          const Eigen::MatrixXi& F,
+                                          const directional::StreamlineData& data)
+{
+  if (data.singularFaces.size() == F.rows())
+    return;
+  
+  data.singularFaces.setZero(F.rows());
+  if (data.effort.size() != data.EF.rows())
+    return;
+  
+  Eigen::VectorXi singVertices, singIndices;
+  directional::effort_to_indices(V, F, data.EV, data.EF, data.effort, data.matching, data.degree, singVertices, singIndices);
+  Eigen::VectorXi isSingular = Eigen::VectorXi::Zero(V.rows());
+  for (int i = 0; i < singVertices.size(); ++i)
+    isSingular(singVertices(i)) = 1;
+  for (int i = 0; i < F.rows(); ++i)
+    for (int j = 0; j < 3; ++j)
+      if (isSingular(F(i, j)))
+        data.singularFaces(i) = 1;
 }
 }
 
@@ -88,22 +123,34 @@ IGL_INLINE void directional::streamlines_init(const Eigen::MatrixXd V,
                                               const int ringDistance,
                                               StreamlineData &data,
                                               StreamlineState &state){
+  directional::MeshContext mesh(V, F);
+  streamlines_init(mesh, temp_field, seedLocations, ringDistance, data, state);
+}
+
+IGL_INLINE void directional::streamlines_init(const MeshContext& mesh,
+                                              const Eigen::MatrixXd &temp_field,
+                                              const Eigen::VectorXi& seedLocations,
+                                              const int ringDistance,
+                                              StreamlineData &data,
+                                              StreamlineState &state){
   using namespace Eigen;
   using namespace std;
   
-  igl::edge_topology(V, F, data.EV, data.FE, data.EF);
-  igl::triangle_triangle_adjacency(F, data.TT);
+  const Eigen::MatrixXi& F = mesh.F;
+  data.EV = mesh.EV();
+  data.FE = mesh.FE();
+  data.EF = mesh.EF();
+  data.TT = mesh.TT();
   
   // prepare vector field
   // --------------------------
   int degree = temp_field.cols()/3;
   data.degree = degree;
   
-  Eigen::MatrixXd FN;
+  const Eigen::MatrixXd& FN = mesh.FN();
   Eigen::VectorXi order;
   Eigen::RowVectorXd sorted;
   
-  igl::per_face_normals(V, F, FN);
   data.field.setZero(F.rows(), degree * 3);
   for (unsigned i = 0; i < F.rows(); ++i){
     const Eigen::RowVectorXd &n = FN.row(i);
@@ -119,8 +166,8 @@ IGL_INLINE void directional::streamlines_init(const Eigen::MatrixXd V,
       data.field.block(i, j * 3, 1, 3) = pd;
     }
   }
-  Eigen::VectorXd effort;
-  directional::principal_matching(V, F, data.EV, data.EF, data.FE, data.field, data.matching, effort);
+  directional::principal_matching(mesh, data.field, data.matching, data.effort);
+  data.singularFaces.resize(0);
   
   // create seeds for tracing
   // --------------------------
@@ -129,7 +176,7 @@ IGL_INLINE void directional::streamlines_init(const Eigen::MatrixXd V,
   
   if (seedLocations.rows()==0){
     assert(ringDistance>=0);
-    Directional::generate_sample_locations(F,data.EF,ringDistance,samples);
+    directional::sample_faces(F,data.EF,ringDistance,samples);
     nsamples = data.nsample = samples.size();
     nsamples = data.nsample;
     /*Eigen::VectorXd r;
@@ -142,9 +189,8 @@ IGL_INLINE void directional::streamlines_init(const Eigen::MatrixXd V,
     nsamples = data.nsample = seedLocations.size();
   }
   
-  Eigen::MatrixXd BC, BC_sample;
-  igl::barycenter(V, F, BC);
-  igl::slice(BC, samples, 1, BC_sample);
+  Eigen::MatrixXd BC_sample;
+  igl::slice(mesh.barycenters(), samples, 1, BC_sample);
   
   // initialize state for tracing vector field
   
@@ -174,54 +220,136 @@ IGL_INLINE void directional::streamlines_next(
   
   state.start_point = state.end_point;
   
-  for (int i = 0; i < degree; ++i)
+  // every line (sample j in direction i) advances independently
+  igl::parallel_for(degree * nsample, [&](const int l)
   {
-    for (int j = 0; j < nsample; ++j)
-    {
-      int f0 = state.current_face(j,i);
-      if (f0 == -1) // reach boundary
-        continue;
-      int m0 = state.current_direction(j, i);
-      
-      // the starting point of the vector
-      const Eigen::RowVector3d &p = state.start_point.row(j + nsample * i);
-      // the direction where we are trying to go
-      const Eigen::RowVector3d &r = data.field.block(f0, 3 * m0, 1, 3);
-      
+    int i = l / nsample, j = l % nsample;
+    int f = state.current_face(j, i);
+    if (f == -1) // reach boundary
+      return;
+    int m = state.current_direction(j, i);
+    Eigen::RowVector3d p = state.start_point.row(l);
+    if (!Directional::streamline_step(V, F, data, f, m, p))
+      return;
+    
+    state.end_point.row(l) = p;
+    state.current_face(j, i) = f;
+    state.current_direction(j, i) = m;
+  }, 1000);
+}
+
+IGL_INLINE void directional::streamlines_trace(const Eigen::MatrixXd& V,
+                                               const Eigen::MatrixXi& F,
+                                               const StreamlineData & data,
+                                               StreamlineState & state,
+                                               const double maxLength,
+                                               const int maxSteps,
+                                               StreamlinePolylines& polylines){
+  using namespace Eigen;
+  using namespace std;
+  
+  int degree = data.degree;
+  int nsample = data.nsample;
+  int numLines = degree * nsample;
+  Directional::streamline_singular_faces(V, F, data);
+  
+  state.start_point = state.end_point;
+  
+  // every worker appends the points of its lines to its own arena, and the arenas are gathered into the flat buffer at the end
+  vector<vector<double>> arenas;
+  vector<int> lineArena(numLines, 0), lineStart(numLines, 0), lineSize(numLines, 0);
+  igl::parallel_for(numLines, [&](const size_t numThreads)
+  {
+    arenas.resize(numThreads);
+  },
+  [&](const int l, const size_t t)
+  {
+    int i = l / nsample, j = l % nsample;
+    int f = state.current_face(j, i);
+    if (f == -1)
+      return;
+    int m = state.current_direction(j, i);
+    RowVector3d p = state.start_point.row(l);
+    vector<double>& arena = arenas[t];
+    lineArena[l] = t;
+    lineStart[l] = arena.size() / 3;
+    arena.insert(arena.end(), p.data(), p.data() + 3);
+    
+    // a line that starts on a singular face stops there, as one that reaches it
+    if (data.singularFaces(f))
+      f = -1;
+    
+    double length = 0.0;
+    for (int step = 0; (step < maxSteps) && (f != -1); ++step){
+      RowVector3d prev = p;
+      if (!Directional::streamline_step(V, F, data, f, m, p)){
+        f = -1;
+        break;
+      }
       
-      // new state,
-      int f1, m1;
+      double segLength = (p - prev).norm();
+      if (length + segLength >= maxLength){
+        if (segLength > 0.0)
+          p = prev + (maxLength - length) * (p - prev) / segLength;
+        else
+          p = prev;
+        arena.insert(arena.end(), p.data(), p.data() + 3);
+        f = -1;
+        break;
+      }
+      length += segLength;
+      arena.insert(arena.end(), p.data(), p.data() + 3);
       
-      for (int k = 0; k < 3; ++k)
-      {
-        f1 = data.TT(f0, k);
-        
-        // edge vertices
-        const Eigen::RowVector3d &q = V.row(F(f0, k));
-        const Eigen::RowVector3d &qs = V.row(F(f0, (k + 1) % 3));
-        // edge direction
-        Eigen::RowVector3d s = qs - q;
-        
-        double u;
-        double t;
-        if (igl::segment_segment_intersect(p, r, q, s, t, u, -1e-6))
-        {
-          // point on next face
-          state.end_point.row(j + nsample * i) = p + t * r;
-          state.current_face(j,i) = f1;
-          
-          // matching direction on next face
-          int e1 = data.FE(f0, k);
-          if (data.EF(e1, 0) == f0)
-            m1 = (data.matching(e1)+m0)%data.degree; //m1 = data.match_ab(e1, m0);
-          else
-            m1 = (-data.matching(e1)+m0+data.degree)%data.degree;  //data.match_ba(e1, m0);
-          
-          state.current_direction(j, i) = m1;
-          break;
-        }
-        
+      if ((f == -1) || (data.singularFaces(f))){
+        f = -1;
+        break;
       }
     }
-  }
+    
+    lineSize[l] = arena.size() / 3 - lineStart[l];
+    state.end_point.row(l) = p;
+    state.current_face(j, i) = f;
+    state.current_direction(j, i) = m;
+  },
+  [](const size_t){}, 100);
+  
+  polylines.offsets.resize(numLines + 1);
+  polylines.offsets[0] = 0;
+  for (int l = 0; l < numLines; ++l)
+    polylines.offsets[l + 1] = polylines.offsets[l] + lineSize[l];
+  
+  polylines.points.resize(3 * polylines.offsets[numLines]);
+  igl::parallel_for(numLines, [&](const int l)
+  {
+    if (lineSize[l] != 0)
+      std::copy(arenas[lineArena[l]].begin() + 3 * lineStart[l],
+                arenas[lineArena[l]].begin() + 3 * (lineStart[l] + lineSize[l]),
+                polylines.points.begin() + 3 * polylines.offsets[l]);
+  }, 1000);
+}
+
+IGL_INLINE void directional::streamlines_trace(const Eigen::MatrixXd& V,
+                                               const Eigen::MatrixXi& F,
+                                               const StreamlineData & data,
+                                               StreamlineState & state,
+                                               const double maxLength,
+                                               const int maxSteps,
+                                               Eigen::MatrixXd& P1,
+                                               Eigen::MatrixXd& P2){
+  StreamlinePolylines polylines;
+  streamlines_trace(V, F, data, state, maxLength, maxSteps, polylines);
+  
+  StreamlinePolylines::VertexMap vertices = polylines.vertices();
+  int numSegments = 0;
+  for (int l = 0; l < polylines.num_lines(); ++l)
+    if (polylines.offsets[l + 1] - polylines.offsets[l] > 1)
+      numSegments += polylines.offsets[l + 1] - polylines.offsets[l] - 1;
+  
+  P1.resize(numSegments, 3);
+  P2.resize(numSegments, 3);
+  for (int l = 0, counter = 0; l < polylines.num_lines(); ++l)
+    for (int k = polylines.offsets[l]; k + 1 < polylines.offsets[l + 1]; ++k, ++counter){
+      P1.row(counter) = vertices.row(k);
+      P2.row(counter) = vertices.row(k + 1);
+    }
 }
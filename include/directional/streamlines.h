@@ -13,6 +13,7 @@
 
 #include <Eigen/Core>
 #include <vector>
+#include <directional/MeshContext.h>
 
 namespace directional
 {
@@ -29,6 +30,9 @@ namespace directional
     //      the vector set in a is matched to vector #mab[i] in b)
     // Eigen::MatrixXi match_ba;   //  #E by N matrix, describing the inverse relation to match_ab
     Eigen::VectorXi matching;
+    Eigen::VectorXd effort;     //  #E principal matching effort, from which the singularities are computed
+    mutable Eigen::VectorXi singularFaces;  //  #F, 1 for faces adjacent to a singular vertex (where streamlines_trace stops), 0 otherwise.
+                                            //  Computed by the first call to streamlines_trace() if empty, and can be set in advance.
     int nsample;                //  #S, number of sample points
     int degree;                 //  #N, degrees of the vector field
   };
@@ -43,6 +47,21 @@ namespace directional
   };
   
   
+  // Traced streamlines as polylines in a single flat buffer (CSR layout): the vertices of line l are rows offsets[l] to offsets[l+1]-1 of vertices().
+  // Line l corresponds to row l of the state (sample j in direction i is line j+#S*i). The buffers keep their capacity between tracing calls.
+  struct StreamlinePolylines
+  {
+    typedef Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor>> VertexMap;
+    
+    std::vector<double> points;   //  3 * #P coordinates of all polyline vertices, line after line
+    std::vector<int> offsets;     //  #lines+1 offsets of each line into the vertices
+    
+    // #P by 3 view of the vertex buffer (no copy)
+    VertexMap vertices() const {return VertexMap(points.data(), points.size() / 3, 3);}
+    int num_lines() const {return offsets.empty() ? 0 : offsets.size() - 1;}
+  };
+  
+  
   // Given a mesh and a field the function computes the /data/ necessary for tracing the field'
   // streamlines, and creates the initial /state/ for the tracing.
   // Input:
@@ -61,6 +80,14 @@ namespace directional
                                    const int ringDistance,
                                    StreamlineData &data,
                                    StreamlineState &state);
+  
+  // Version with the topology, normals and barycenters taken from a MeshContext.
+  IGL_INLINE void streamlines_init(const MeshContext& mesh,
+                                   const Eigen::MatrixXd &rawField,
+                                   const Eigen::VectorXi& seedLocations,
+                                   const int ringDistance,
+                                   StreamlineData &data,
+                                   StreamlineState &state);
 
 
   
@@ -75,6 +102,39 @@ namespace directional
                                    const StreamlineData & data,
                                    StreamlineState & state
                                    );
+  
+  // Traces every streamline of the state to completion in a single call, rather than one face per call as streamlines_next().
+  // Each line advances independently (and in parallel) until it leaves through the boundary, enters a face adjacent to a singularity,
+  // or reaches the maximal length.
+  // Input:
+  //   V             #V by 3 list of mesh vertex coordinates
+  //   F             #F by 3 list of mesh faces
+  //   data          struct containing topology information
+  //   state         struct containing the state of the tracing
+  //   maxLength     maximal length each line is traced in this call
+  //   maxSteps      maximal number of faces each line crosses in this call (guards against closed streamlines)
+  // Output:
+  //   state         the state at the end of the lines; current_face is -1 for the lines that have stopped
+  //   polylines     the traced lines (one per row of the state, empty for lines that had already stopped)
+  IGL_INLINE void streamlines_trace(const Eigen::MatrixXd& V,
+                                    const Eigen::MatrixXi& F,
+                                    const StreamlineData & data,
+                                    StreamlineState & state,
+                                    const double maxLength,
+                                    const int maxSteps,
+                                    StreamlinePolylines& polylines);
+  
+  // Version that outputs the traced segments, as used by the edge visualization functions
+  // Output:
+  //   P1, P2        #segments by 3 start and end points of all traced segments, line after line
+  IGL_INLINE void streamlines_trace(const Eigen::MatrixXd& V,
+                                    const Eigen::MatrixXi& F,
+                                    const StreamlineData & data,
+                                    StreamlineState & state,
+                                    const double maxLength,
+                                    const int maxSteps,
+                                    Eigen::MatrixXd& P1,
+                                    Eigen::MatrixXd& P2);
 }
 
 #include "streamlines.cpp"
@@ -19,6 +19,8 @@
 #include <directional/SubdivisionInternal/DirectionalGamma_Suite.h>
 #include <directional/rawfield_to_columndirectional.h>
 #include <directional/columndirectional_to_rawfield.h>
+#include <directional/curl_matching.h>
+#include <directional/MeshContext.h>
 
 namespace directional
 {
@@ -141,6 +143,43 @@ namespace directional
     
     subdivide_field(VCoarse, FCoarse, EVCoarse, EFCoarse, rawFieldCoarse, matchingCoarse, targetLevel, VFine, FFine, EVFine, EFFine, rawFieldFine, matchingFine);
   }
+  
+  /**
+   * Version of subdivide_field with a given matching, where the coarse mesh and its edge topology are taken from a MeshContext.
+   */
+  inline void subdivide_field(const MeshContext& meshCoarse,
+                              const Eigen::MatrixXd& rawField,
+                              const Eigen::VectorXi& matching,
+                              int targetLevel,
+                              Eigen::MatrixXd& V_fine,
+                              Eigen::MatrixXi& F_fine,
+                              Eigen::MatrixXi& EV_fine,
+                              Eigen::MatrixXi& EF_fine,
+                              Eigen::MatrixXd& rawField_fine,
+                              Eigen::VectorXi& matching_fine)
+  {
+    subdivide_field(meshCoarse.V, meshCoarse.F, meshCoarse.EV(), meshCoarse.EF(), rawField, matching, targetLevel, V_fine, F_fine, EV_fine, EF_fine, rawField_fine, matching_fine);
+  }
+  
+  /**
+   * Version of subdivide_field with curl matching, where the coarse mesh and its edge topology are taken from a MeshContext.
+   */
+  inline void subdivide_field(const MeshContext& meshCoarse,
+                              const Eigen::MatrixXd& rawFieldCoarse,
+                              int targetLevel,
+                              Eigen::MatrixXd& VFine,
+                              Eigen::MatrixXi& FFine,
+                              Eigen::MatrixXd& rawFieldFine)
+  {
+    Eigen::MatrixXi EVFine, EFFine;
+    Eigen::VectorXi matchingCoarse, matchingFine;
+    {
+      Eigen::VectorXd effort, curlNorm;
+      directional::curl_matching(meshCoarse.V, meshCoarse.F, meshCoarse.EV(), meshCoarse.EF(), meshCoarse.FE(), rawFieldCoarse, matchingCoarse, effort, curlNorm);
+    }
+    
+    subdivide_field(meshCoarse, rawFieldCoarse, matchingCoarse, targetLevel, VFine, FFine, EVFine, EFFine, rawFieldFine, matchingFine);
+  }
 
 }
 
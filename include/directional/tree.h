@@ -9,7 +9,6 @@
 #include <igl/igl_inline.h>
 #include <Eigen/Core>
 #include <vector>
-#include <queue>
 
 
 namespace directional
@@ -27,62 +26,61 @@ namespace directional
   {
     using namespace Eigen;
     int numV=EV.maxCoeff()+1;
-    VectorXi Valences=VectorXi::Zero(numV);
+    
+    //vertex-edge adjacency in compressed rows: the edges of vertex v are VE[VEOffsets[v]..VEOffsets[v+1]-1]
+    std::vector<int> VEOffsets(numV+1,0);
     for (int i=0;i<EV.rows();i++){
       if (EV(i, 0) == -1 || EV(i, 1) == -1)
         continue;
-      Valences(EV(i,0))++;
-      Valences(EV(i,1))++;
+      VEOffsets[EV(i,0)+1]++;
+      VEOffsets[EV(i,1)+1]++;
     }
+    for (int i=0;i<numV;i++)
+      VEOffsets[i+1]+=VEOffsets[i];
     
-    MatrixXi VE(numV, Valences.maxCoeff());
-    Valences.setZero();
+    std::vector<int> VE(VEOffsets[numV]);
+    std::vector<int> fillOffsets(VEOffsets.begin(), VEOffsets.end()-1);
     for (int i=0;i<EV.rows();i++){
       if (EV(i, 0) == -1 || EV(i, 1) == -1)
         continue;
-      VE(EV(i,0), Valences(EV(i,0))++)=i;
-      VE(EV(i,1), Valences(EV(i,1))++)=i;
+      VE[fillOffsets[EV(i,0)]++]=i;
+      VE[fillOffsets[EV(i,1)]++]=i;
     }
     
-    Eigen::VectorXi usedVertices=VectorXi::Zero(numV);
-    int numUsed=0;
-    
-    //queue and initial possible edges
-    std::queue<std::pair<int,int> > edgeVertices;
-    
     tE.resize(numV-1);
     tEf.resize(numV);
     tEf.setConstant(-2);
-    int currEdgeIndex=0;
-    int start = 0;
     
     //Try to find initial possible root for the tree.
-    while (Valences[start] == 0)
-      if (++start > Valences.size())
-        return;
+    int start = 0;
+    while ((start<numV)&&(VEOffsets[start+1]==VEOffsets[start]))
+      start++;
+    if (start==numV)
+      return;
     
-    edgeVertices.push(std::pair<int, int>(-1, start));
-    do{
-      std::pair<int, int> currEdgeVertex=edgeVertices.front();
-      edgeVertices.pop();
-      if (usedVertices(currEdgeVertex.second))
-        continue;
-      
-      if (currEdgeVertex.first!=-1)
-        tE(currEdgeIndex++)=currEdgeVertex.first;
-      tEf(currEdgeVertex.second)=currEdgeVertex.first;
-      usedVertices(currEdgeVertex.second)=1;
+    //BFS where every vertex is queued once, with the edge that first reached it (which is the edge that reaches it first in FIFO order)
+    std::vector<int> vertexQueue;
+    vertexQueue.reserve(numV);
+    vertexQueue.push_back(start);
+    tEf(start)=-1;
+    int currEdgeIndex=0;
+    for (int q=0;q<(int)vertexQueue.size();q++){
+      int currVertex=vertexQueue[q];
+      if (tEf(currVertex)!=-1)
+        tE(currEdgeIndex++)=tEf(currVertex);
       
       //inserting the new unused vertices
-      for (int i=0;i<Valences(currEdgeVertex.second);i++){
-        int nextEdge=VE(currEdgeVertex.second, i);
-        int nextVertex=(EV(nextEdge, 0)==currEdgeVertex.second ? EV(nextEdge, 1) : EV(nextEdge, 0));
-        if (!usedVertices(nextVertex))
-          edgeVertices.push(std::pair<int, int>(nextEdge, nextVertex));
+      for (int i=VEOffsets[currVertex];i<VEOffsets[currVertex+1];i++){
+        int nextEdge=VE[i];
+        int nextVertex=(EV(nextEdge, 0)==currVertex ? EV(nextEdge, 1) : EV(nextEdge, 0));
+        if (tEf(nextVertex)==-2){
+          tEf(nextVertex)=nextEdge;
+          vertexQueue.push_back(nextVertex);
+        }
       }
-    }while (edgeVertices.size()!=0);
+    }
     
-    tE.conservativeResize(usedVertices.sum() - 1);
+    tE.conservativeResize(currEdgeIndex);
   }
   
 }
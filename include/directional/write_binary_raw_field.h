@@ -0,0 +1,90 @@
+// This file is part of Directional, a library for directional field processing.
+// Copyright (C) 2018 Amir Vaxman <avaxman@gmail.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef DIRECTIONAL_WRITE_BINARY_RAW_FIELD_H
+#define DIRECTIONAL_WRITE_BINARY_RAW_FIELD_H
+
+#include <cstdint>
+#include <cstring>
+#include <Eigen/Core>
+#include <string>
+#include <fstream>
+#include <igl/igl_inline.h>
+#include <directional/read_binary_raw_field.h>
+
+namespace directional
+{
+
+  // Writes a directional field to file in the binary raw format (see read_binary_raw_field.h), with optional matching and singularities
+  // Inputs:
+  //   fileName:        The name of the file
+  //   rawField:        #F by 3*N in xyzxyz format (N is derived from F.cols())
+  //   matching:        #E matching, or empty to not store it
+  //   singVertices:    The singular vertices, or empty to not store them
+  //   singIndices:     The index of the singularities, where the actual fractional index is singIndices/N.
+  //   singlePrecision: if true the field is stored in single precision
+  // Returns:
+  //   Whether or not the file was written successfully (never on big-endian hosts)
+  bool IGL_INLINE write_binary_raw_field(const std::string& fileName,
+                                         const Eigen::MatrixXd& rawField,
+                                         const Eigen::VectorXi& matching,
+                                         const Eigen::VectorXi& singVertices,
+                                         const Eigen::VectorXi& singIndices,
+                                         bool singlePrecision = false)
+  {
+    typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> RowMatrixXd;
+    typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> RowMatrixXf;
+    typedef Eigen::Matrix<std::int32_t, Eigen::Dynamic, 1> VectorXi32;
+    
+    if (!binary_raw_field_host_supported())
+      return false;
+    
+    int N = rawField.cols() / 3;
+    assert(3 * N == rawField.cols());
+    assert(singVertices.size() == singIndices.size());
+    
+    BinaryRawFieldHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "DRFB", 4);
+    header.version = BINARY_RAW_FIELD_VERSION;
+    header.N = N;
+    header.dtype = (singlePrecision ? BINARY_RAW_FIELD_FLOAT : BINARY_RAW_FIELD_DOUBLE);
+    header.numF = rawField.rows();
+    header.numMatching = matching.size();
+    header.numSingularities = singVertices.size();
+    header.dataOffset = sizeof(BinaryRawFieldHeader);
+    
+    std::ofstream f(fileName, std::ios::binary);
+    f.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (singlePrecision){
+      RowMatrixXf rowField = rawField.cast<float>();
+      f.write(reinterpret_cast<const char*>(rowField.data()), rowField.size() * sizeof(float));
+    } else {
+      RowMatrixXd rowField = rawField;
+      f.write(reinterpret_cast<const char*>(rowField.data()), rowField.size() * sizeof(double));
+    }
+    
+    VectorXi32 buffer = matching.cast<std::int32_t>();
+    f.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(std::int32_t));
+    buffer = singVertices.cast<std::int32_t>();
+    f.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(std::int32_t));
+    buffer = singIndices.cast<std::int32_t>();
+    f.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(std::int32_t));
+    
+    f.close();
+    return !f.fail();
+  }
+  
+  // Writes only the raw field in binary format
+  bool IGL_INLINE write_binary_raw_field(const std::string& fileName,
+                                         const Eigen::MatrixXd& rawField,
+                                         bool singlePrecision = false)
+  {
+    return write_binary_raw_field(fileName, rawField, Eigen::VectorXi(), Eigen::VectorXi(), Eigen::VectorXi(), singlePrecision);
+  }
+}
+
+#endif